@@ -13,8 +13,10 @@ if test "$PHP_PDO_MIMER" != "no"; then
 
   PHP_CHECK_PDO_INCLUDES
   PHP_ADD_LIBRARY(mimerapi,, PDO_MIMER_SHARED_LIBADD)
+
+  PHP_ADD_LIBRARY(pthread,, PDO_MIMER_SHARED_LIBADD)
   PHP_SUBST(PDO_MIMER_SHARED_LIBADD)
 
-  PHP_NEW_EXTENSION(pdo_mimer, pdo_mimer.c mimer_driver.c mimer_stmt.c , $ext_shared,,-I$pdo_cv_inc_path)
+  PHP_NEW_EXTENSION(pdo_mimer, pdo_mimer.c mimer_driver.c mimer_stmt.c mimer_async.c mimer_parallel.c mimer_prefetch.c mimer_script.c mimer_stats.c mimer_worker.c , $ext_shared,,-I$pdo_cv_inc_path)
   PHP_ADD_EXTENSION_DEP(pdo_mimer, pdo)
 fi
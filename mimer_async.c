@@ -0,0 +1,419 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "zend_exceptions.h"
+#include "pdo/php_pdo.h"
+#include "pdo/php_pdo_driver.h"
+#include "php_pdo_mimer.h"
+#include "php_pdo_mimer_int.h"
+#include "pdo_mimer_thread.h"
+#include "mimer_async_arginfo.h"
+
+/**
+ * @brief An asynchronous query, run by a worker thread on a session of its own.
+ * @remark Only plain malloc() memory is shared with the worker thread, which must not touch the Zend engine. The
+ * results are turned into zvals by the PHP thread once the worker is done.
+ */
+typedef struct pdo_mimer_async_t {
+	pdo_mimer_mutex lock;
+	pdo_mimer_cond cond;
+	pdo_mimer_thread thread;
+	bool is_running;             /* the thread has been started and not joined */
+	bool is_done;                /* the worker has finished, under the lock */
+
+	/* input, set before the worker starts */
+	pdo_mimer_worker_session session;
+	char *sql;
+	int num_params;
+	pdo_mimer_worker_param *params;
+
+	/* output, read once the worker is done */
+	pdo_mimer_rows rows;
+	char **column_names;
+	bool has_result_set;
+	int64_t row_count;           /* rows fetched, or affected by a statement which returns no result set */
+	pdo_mimer_worker_error error;
+} pdo_mimer_async;
+
+typedef struct pdo_mimer_async_result_t {
+	pdo_mimer_async *async;
+	zend_object *dbh_object;     /* the PDO object, kept alive for the session to be given back to its pool */
+	bool is_collected;           /* the worker has been joined and the session given back */
+	pdo_mimer_strings strings;
+	zend_object std;
+} pdo_mimer_async_result;
+
+static zend_class_entry *pdo_mimer_async_result_ce;
+static zend_object_handlers pdo_mimer_async_result_handlers;
+
+static inline pdo_mimer_async_result *pdo_mimer_async_result_from_obj(zend_object *obj) {
+	return (pdo_mimer_async_result *) ((char *) obj - XtOffsetOf(pdo_mimer_async_result, std));
+}
+
+#define Z_MIMER_ASYNC_RESULT_P(zv) pdo_mimer_async_result_from_obj(Z_OBJ_P(zv))
+
+
+/**
+ * @brief Runs the query: prepares it, sets its parameters, and executes it or fetches all its rows.
+ * @remark Worker thread.
+ */
+static void pdo_mimer_async_run(pdo_mimer_async *async) {
+	MimerStatement statement = MIMERNULLHANDLE;
+	MimerReturnCode return_code = MIMER_SUCCESS;
+
+	if (!pdo_mimer_worker_session_begin(&async->session, &async->error))
+		return;
+
+	if (!MIMER_SUCCEEDED(MimerBeginStatement8(async->session.session, async->sql, MIMER_FORWARD_ONLY, &statement))) {
+		pdo_mimer_worker_api_error(&async->error, (MimerHandle) async->session.session);
+		return;
+	}
+
+	for (int16_t paramno = 1; paramno <= async->num_params && MIMER_SUCCEEDED(return_code); paramno++)
+		return_code = pdo_mimer_worker_param_set(&async->params[paramno - 1], statement, paramno);
+
+	if (!MIMER_SUCCEEDED(return_code)) {
+		/* reported below */
+	} else if ((async->has_result_set = MimerStatementHasResultSet(statement))) {
+		if ((return_code = pdo_mimer_rows_init(&async->rows, statement, MimerColumnCount(statement))) == MIMER_SUCCESS)
+			return_code = pdo_mimer_worker_column_names(statement, async->rows.num_columns, &async->column_names);
+
+		if (return_code == MIMER_SUCCESS && MIMER_SUCCEEDED(return_code = MimerOpenCursor(statement))) {
+			while (MIMER_SUCCEEDED(return_code = MimerFetch(statement)) && return_code != MIMER_NO_DATA) {
+				if ((return_code = pdo_mimer_rows_add(&async->rows, statement)) != MIMER_SUCCESS)
+					break;
+			}
+			async->row_count = async->rows.num_rows;
+		}
+	} else if (MIMER_SUCCEEDED(return_code = MimerExecute(statement))) {
+		async->row_count = return_code;
+	}
+
+	if (return_code == PDO_MIMER_UNKNOWN_COLUMN_TYPE)
+		pdo_mimer_worker_custom_error(&async->error, SQLSTATE_FEATURE_NOT_SUPPORTED, PDO_MIMER_FEATURE_NOT_IMPLEMENTED,
+			"LOB columns cannot be fetched by an asynchronous query");
+	else
+		pdo_mimer_worker_error_from(&async->error, return_code, (MimerHandle) statement);
+
+	MimerEndStatement(&statement);
+}
+
+
+PDO_MIMER_THREAD_FUNC(pdo_mimer_async_main, arg) {
+	pdo_mimer_async *async = arg;
+
+	pdo_mimer_async_run(async);
+
+	pdo_mimer_mutex_lock(&async->lock);
+	async->is_done = true;
+	pdo_mimer_cond_broadcast(&async->cond);
+	pdo_mimer_mutex_unlock(&async->lock);
+
+	PDO_MIMER_THREAD_RETURN;
+}
+
+
+static void pdo_mimer_async_free(pdo_mimer_async *async) {
+	pdo_mimer_cond_destroy(&async->cond);
+	pdo_mimer_mutex_destroy(&async->lock);
+
+	for (int i = 0; i < async->num_params; i++)
+		pdo_mimer_worker_param_free(&async->params[i]);
+	free(async->params);
+
+	pdo_mimer_worker_column_names_free(async->column_names, async->rows.num_columns);
+
+	pdo_mimer_rows_free(&async->rows);
+	free(async->sql);
+	pdo_mimer_worker_error_free(&async->error);
+	free(async);
+}
+
+
+/**
+ * @brief Waits for the worker to finish, and gives its session back to the connection's pool.
+ * @param result [in] The result of the asynchronous query.
+ */
+static void pdo_mimer_async_collect(pdo_mimer_async_result *result) {
+	pdo_mimer_async *async = result->async;
+
+	if (result->is_collected)
+		return;
+
+	if (async->is_running)
+		pdo_mimer_thread_join(async->thread);
+	async->is_running = false;
+	result->is_collected = true;
+
+	/* at shutdown the connection may have been freed first */
+	pdo_mimer_worker_session_release(OBJ_FLAGS(result->dbh_object) & IS_OBJ_FREE_CALLED ? NULL :
+		php_pdo_dbh_fetch_inner(result->dbh_object)->driver_data, &async->session, &async->error);
+}
+
+
+/**
+ * @brief Waits for the query and reports its error, if any, on the connection like any of its errors.
+ * @return true if the query succeeded
+ */
+static bool pdo_mimer_async_await(pdo_mimer_async_result *result) {
+	pdo_mimer_async *async = result->async;
+	pdo_dbh_t *dbh = php_pdo_dbh_fetch_inner(result->dbh_object);
+
+	pdo_mimer_async_collect(result);
+
+	strcpy(dbh->error_code, PDO_ERR_NONE);
+	if (!pdo_mimer_worker_set_error(dbh, &async->error))
+		return true;
+
+	pdo_handle_error(dbh, NULL);
+	return false;
+}
+
+
+static zend_object *pdo_mimer_async_result_create(zend_class_entry *ce) {
+	pdo_mimer_async_result *result = zend_object_alloc(sizeof(pdo_mimer_async_result), ce);
+
+	zend_object_std_init(&result->std, ce);
+	object_properties_init(&result->std, ce);
+	result->std.handlers = &pdo_mimer_async_result_handlers;
+
+	return &result->std;
+}
+
+
+static void pdo_mimer_async_result_free(zend_object *obj) {
+	pdo_mimer_async_result *result = pdo_mimer_async_result_from_obj(obj);
+
+	if (result->async != NULL) {
+		pdo_mimer_async_collect(result);
+		pdo_mimer_async_free(result->async);
+		pdo_mimer_strings_free(&result->strings);
+		OBJ_RELEASE(result->dbh_object);
+	}
+
+	zend_object_std_dtor(obj);
+}
+
+
+static zend_function *pdo_mimer_async_result_get_constructor(zend_object *object) {
+	zend_throw_error(NULL, "Cannot directly construct MimerAsyncResult, use PDO::mimerQueryAsync() instead");
+	return NULL;
+}
+
+
+/**
+ * @brief Registers the <code>MimerAsyncResult</code> class.
+ */
+void pdo_mimer_async_register_class(void) {
+	pdo_mimer_async_result_ce = register_class_MimerAsyncResult();
+	pdo_mimer_async_result_ce->create_object = pdo_mimer_async_result_create;
+
+	memcpy(&pdo_mimer_async_result_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	pdo_mimer_async_result_handlers.offset = XtOffsetOf(pdo_mimer_async_result, std);
+	pdo_mimer_async_result_handlers.free_obj = pdo_mimer_async_result_free;
+	pdo_mimer_async_result_handlers.get_constructor = pdo_mimer_async_result_get_constructor;
+	pdo_mimer_async_result_handlers.clone_obj = NULL;
+}
+
+
+/**
+ * @brief Ends the idle sessions kept for asynchronous queries.
+ * @param mimer_dbh [in] The connection.
+ * @param is_persistent [in] Whether the connection is persistent.
+ */
+void pdo_mimer_async_free_pool(pdo_mimer_dbh *mimer_dbh, bool is_persistent) {
+	while (mimer_dbh->async.num_idle > 0)
+		MimerEndSession(&mimer_dbh->async.idle[--mimer_dbh->async.num_idle]);
+
+	if (mimer_dbh->async.db_name != NULL) {
+		pefree(mimer_dbh->async.db_name, is_persistent);
+		mimer_dbh->async.db_name = NULL;
+	}
+}
+
+
+/**
+ * @brief The PHP method <code>PDO::mimerQueryAsync()</code> runs a query on a worker thread with a session of its own,
+ * so that several queries run at the same time.
+ * @param sql [in] The query, with positional placeholders.
+ * @param params [in] The values of the placeholders, scalars or null.
+ * @param options [in] <code>PDO::MIMER_ATTR_TRIM_CHAR</code> and <code>PDO::MIMER_ATTR_DEDUP_STRINGS</code>, applied to
+ * the rows as for a statement.
+ * @param return_value [out] A <code>MimerAsyncResult</code> to wait for the query with and get its rows from.
+ * @remark The query runs outside of the connection's transaction, and commits on its own. Idle sessions are kept for
+ * the next queries, up to <code>PDO_MIMER_ASYNC_POOL_SIZE</code> of them.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerQueryAsync) {
+	pdo_dbh_t *dbh = Z_PDO_DBH_P(ZEND_THIS);
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+	zend_string *sql;
+	HashTable *params = NULL, *options = NULL;
+	zval *value;
+
+	ZEND_PARSE_PARAMETERS_START(1, 3)
+		Z_PARAM_STR(sql)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_ARRAY_HT(params)
+		Z_PARAM_ARRAY_HT(options)
+	ZEND_PARSE_PARAMETERS_END();
+
+	pdo_mimer_async *async = calloc(1, sizeof(pdo_mimer_async));
+	if (async == NULL) {
+		zend_throw_error(NULL, "Out of memory");
+		RETURN_THROWS();
+	}
+
+	pdo_mimer_mutex_init(&async->lock);
+	pdo_mimer_cond_init(&async->cond);
+	bool is_ok = (async->sql = pdo_mimer_worker_strdup(ZSTR_VAL(sql), ZSTR_LEN(sql))) != NULL;
+
+	if (is_ok && params != NULL && zend_hash_num_elements(params) > 0) {
+		is_ok = (async->params = calloc(zend_hash_num_elements(params), sizeof(pdo_mimer_worker_param))) != NULL;
+
+		ZEND_HASH_FOREACH_VAL(params, value) {
+			if (!is_ok)
+				break;
+			is_ok = pdo_mimer_worker_param_init(&async->params[async->num_params++], value);
+		} ZEND_HASH_FOREACH_END();
+
+		if (!is_ok && async->params != NULL && !EG(exception)) {
+			pdo_mimer_async_free(async);
+			zend_argument_type_error(2, "must contain only scalar or null values");
+			RETURN_THROWS();
+		}
+	}
+
+	if (is_ok)
+		is_ok = pdo_mimer_worker_session_take(dbh, &async->session);
+
+	if (!is_ok) {
+		pdo_mimer_worker_session_release(mimer_dbh, &async->session, &async->error);
+		pdo_mimer_async_free(async);
+		zend_throw_error(NULL, "Out of memory");
+		RETURN_THROWS();
+	}
+
+	object_init_ex(return_value, pdo_mimer_async_result_ce);
+	pdo_mimer_async_result *result = Z_MIMER_ASYNC_RESULT_P(return_value);
+	result->async = async;
+	result->dbh_object = Z_OBJ_P(ZEND_THIS);
+	GC_ADDREF(result->dbh_object);
+	pdo_mimer_strings_init(&result->strings, options);
+
+	/* without a thread the query is run here, the result is then ready at once */
+	if (!(async->is_running = pdo_mimer_thread_create(&async->thread, pdo_mimer_async_main, async)))
+		pdo_mimer_async_main(async);
+}
+
+
+/**
+ * @brief The PHP method <code>MimerAsyncResult::isReady()</code> tells whether the query has finished, without waiting.
+ */
+PHP_METHOD(MimerAsyncResult, isReady) {
+	pdo_mimer_async *async = Z_MIMER_ASYNC_RESULT_P(ZEND_THIS)->async;
+
+	ZEND_PARSE_PARAMETERS_NONE();
+
+	pdo_mimer_mutex_lock(&async->lock);
+	bool is_done = async->is_done;
+	pdo_mimer_mutex_unlock(&async->lock);
+
+	RETURN_BOOL(is_done);
+}
+
+
+/**
+ * @brief The PHP method <code>MimerAsyncResult::await()</code> waits for the query to finish.
+ * @param return_value [out] true if the query succeeded, false if it failed and the error mode is not exceptions.
+ */
+PHP_METHOD(MimerAsyncResult, await) {
+	ZEND_PARSE_PARAMETERS_NONE();
+
+	RETURN_BOOL(pdo_mimer_async_await(Z_MIMER_ASYNC_RESULT_P(ZEND_THIS)));
+}
+
+
+/**
+ * @brief The PHP method <code>MimerAsyncResult::fetchAll()</code> waits for the query and returns its rows.
+ * @param mode [in] PDO::FETCH_ASSOC or PDO::FETCH_NUM.
+ * @param return_value [out] The rows, an empty array if the query returns no result set, or false if it failed.
+ */
+PHP_METHOD(MimerAsyncResult, fetchAll) {
+	pdo_mimer_async_result *result = Z_MIMER_ASYNC_RESULT_P(ZEND_THIS);
+	pdo_mimer_async *async = result->async;
+	zend_long mode = PDO_FETCH_ASSOC;
+
+	ZEND_PARSE_PARAMETERS_START(0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(mode)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (mode != PDO_FETCH_ASSOC && mode != PDO_FETCH_NUM) {
+		zend_argument_value_error(1, "must be either PDO::FETCH_ASSOC or PDO::FETCH_NUM");
+		RETURN_THROWS();
+	}
+
+	if (!pdo_mimer_async_await(result))
+		RETURN_FALSE;
+
+	const pdo_mimer_rows *rows = &async->rows;
+	zend_string **names = NULL;
+
+	if (mode == PDO_FETCH_ASSOC && rows->num_rows > 0)
+		names = pdo_mimer_worker_names_init(php_pdo_dbh_fetch_inner(result->dbh_object)->driver_data,
+			async->column_names, rows->num_columns);
+
+	array_init_size(return_value, rows->num_rows);
+
+	for (int row = 0; row < rows->num_rows; row++) {
+		zval entry;
+
+		pdo_mimer_worker_row_zval(rows, row, names, &result->strings, &entry);
+		zend_hash_next_index_insert_new(Z_ARRVAL_P(return_value), &entry);
+	}
+
+	pdo_mimer_worker_names_release(names, rows->num_columns);
+}
+
+
+/**
+ * @brief The PHP method <code>MimerAsyncResult::rowCount()</code> waits for the query and returns the number of rows it
+ * fetched or, for a statement returning no result set, affected.
+ */
+PHP_METHOD(MimerAsyncResult, rowCount) {
+	pdo_mimer_async_result *result = Z_MIMER_ASYNC_RESULT_P(ZEND_THIS);
+
+	ZEND_PARSE_PARAMETERS_NONE();
+
+	if (!pdo_mimer_async_await(result))
+		RETURN_FALSE;
+
+	RETURN_LONG(result->async->row_count);
+}
@@ -0,0 +1,18 @@
+<?php
+
+/** @generate-class-entries */
+
+/**
+ * @strict-properties
+ * @not-serializable
+ */
+final class MimerAsyncResult {
+
+    public function isReady(): bool {}
+
+    public function await(): bool {}
+
+    public function fetchAll(int $mode = PDO::FETCH_ASSOC): array|false {}
+
+    public function rowCount(): int|false {}
+}
@@ -0,0 +1,40 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: 26eccfcbf2620bc2622f219e6e4c56d8639deb40 */
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_MimerAsyncResult_isReady, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_class_MimerAsyncResult_await arginfo_class_MimerAsyncResult_isReady
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_class_MimerAsyncResult_fetchAll, 0, 0, MAY_BE_ARRAY|MAY_BE_FALSE)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, mode, IS_LONG, 0, "PDO::FETCH_ASSOC")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_class_MimerAsyncResult_rowCount, 0, 0, MAY_BE_LONG|MAY_BE_FALSE)
+ZEND_END_ARG_INFO()
+
+
+ZEND_METHOD(MimerAsyncResult, isReady);
+ZEND_METHOD(MimerAsyncResult, await);
+ZEND_METHOD(MimerAsyncResult, fetchAll);
+ZEND_METHOD(MimerAsyncResult, rowCount);
+
+
+static const zend_function_entry class_MimerAsyncResult_methods[] = {
+	ZEND_ME(MimerAsyncResult, isReady, arginfo_class_MimerAsyncResult_isReady, ZEND_ACC_PUBLIC)
+	ZEND_ME(MimerAsyncResult, await, arginfo_class_MimerAsyncResult_await, ZEND_ACC_PUBLIC)
+	ZEND_ME(MimerAsyncResult, fetchAll, arginfo_class_MimerAsyncResult_fetchAll, ZEND_ACC_PUBLIC)
+	ZEND_ME(MimerAsyncResult, rowCount, arginfo_class_MimerAsyncResult_rowCount, ZEND_ACC_PUBLIC)
+	ZEND_FE_END
+};
+
+static zend_class_entry *register_class_MimerAsyncResult(void)
+{
+	zend_class_entry ce, *class_entry;
+
+	INIT_CLASS_ENTRY(ce, "MimerAsyncResult", class_MimerAsyncResult_methods);
+	class_entry = zend_register_internal_class_ex(&ce, NULL);
+	class_entry->ce_flags |= ZEND_ACC_FINAL|ZEND_ACC_NO_DYNAMIC_PROPERTIES|ZEND_ACC_NOT_SERIALIZABLE;
+
+	return class_entry;
+}
@@ -36,6 +36,9 @@
 #include "php_pdo_mimer_int.h"
 #include "pdo_mimer_error.h"
 #include "mimer_stmt_arginfo.h"
+#include "mimer_driver_arginfo.h"
+#include "zend_exceptions.h"
+#include "zend_smart_str.h"
 
 /**
  * @brief Mimer PDO specific implementation of PHP streams' write. 
@@ -62,6 +65,11 @@ static ssize_t mimer_lob_read(php_stream *stream, char *buf, size_t count) {
     if (stream->eof)
         return SUCCESS;
 
+    /* the LOB is read on the connection's session, which a prefetch thread may be using */
+    pdo_dbh_t *dbh = Z_PDO_DBH_P(&stream_data->dbh_zv);
+    if (dbh->driver_data != NULL)
+        pdo_mimer_claim_sessions((pdo_mimer_dbh *) dbh->driver_data);
+
     if(MimerIsBlob(stream_data->lob_type))
         rc = MimerGetBlobData(&stream_data->lob_handle, buf, count);
     else if(MimerIsClob(stream_data->lob_type) || MimerIsNclob(stream_data->lob_type))
@@ -71,7 +79,10 @@ static ssize_t mimer_lob_read(php_stream *stream, char *buf, size_t count) {
     
     if (MIMER_SUCCEEDED(rc)) {
         stream->eof = rc <= count;
-        return stream->eof ? rc : (ssize_t) count;
+        ssize_t nread = stream->eof ? rc : (ssize_t) count;
+        PDO_MIMER_STATS_ADD(bytes_in, nread);
+        PDO_MIMER_STATS_ADD(lob_bytes, nread);
+        return nread;
     } else 
         return FAILURE;
 }
@@ -85,6 +96,7 @@ static ssize_t mimer_lob_read(php_stream *stream, char *buf, size_t count) {
 static int mimer_lob_close(php_stream *stream, int close_handle) {
     pdo_mimer_lob_stream_data *self = (pdo_mimer_lob_stream_data*)stream->abstract;
     if (close_handle){
+        zval_ptr_dtor(&self->dbh_zv);
         efree(self);
     }
 	return SUCCESS;
@@ -135,6 +147,7 @@ php_stream *pdo_mimer_create_lob_stream(pdo_stmt_t *stmt, int colno, int32_t lob
 
 	 pdo_mimer_lob_stream_data *stream_data = emalloc(sizeof(pdo_mimer_lob_stream_data));
 	 stream_data->lob_type = lob_type;
+	 ZVAL_COPY(&stream_data->dbh_zv, &stmt->database_object_handle);
 
     if (!MIMER_SUCCEEDED(MimerGetLob(mimer_stmt->stmt, colno, &lob_size, &stream_data->lob_handle))) {
         pdo_mimer_stmt_error();
@@ -147,64 +160,273 @@ php_stream *pdo_mimer_create_lob_stream(pdo_stmt_t *stmt, int colno, int32_t lob
     return stream;
 
     cleanup:
+    zval_ptr_dtor(&stream_data->dbh_zv);
     efree(stream_data);
     return NULL;
 }
 
 
+/**
+ * @brief Maps a single native error code to a SQLSTATE.
+ * @remark Grouped by SQLSTATE class here, @ref pdo_mimer_sqlstate_map_init sorts it on @p first for the binary search.
+ */
+static pdo_mimer_sqlstate_map_entry pdo_mimer_sqlstate_codes[] = {
+	{ MIMER_SUCCESS,                     MIMER_SUCCESS,                     SQLSTATE_SUCCESSFUL_COMPLETION },
+	{ MIMER_NO_DATA,                     MIMER_NO_DATA,                     SQLSTATE_NO_DATA },
+	{ MIMER_SEQUENCE_ERROR,              MIMER_SEQUENCE_ERROR,              SQLSTATE_FUNCTION_SEQUENCE_ERROR },
+	{ PDO_MIMER_LOGIN_ERROR,             PDO_MIMER_LOGIN_ERROR,             SQLSTATE_INVALID_AUTHORIZATION_SPECIFICATION },
+	{ PDO_MIMER_LOGIN_FAILURE,           PDO_MIMER_LOGIN_FAILURE,           SQLSTATE_INVALID_AUTHORIZATION_SPECIFICATION },
+	{ PDO_MIMER_TRANSACTION_CONFLICT,    PDO_MIMER_TRANSACTION_CONFLICT,    SQLSTATE_SERIALIZATION_FAILURE },
+	{ PDO_MIMER_INCOMPLETE_PARAMETERS,   PDO_MIMER_INCOMPLETE_PARAMETERS,   SQLSTATE_USING_CLAUSE_DOES_NOT_MATCH_DYNAMIC_PARAMETER_SPECIFICATIONS },
+	{ PDO_MIMER_GENERAL_ERROR,           PDO_MIMER_GENERAL_ERROR,           SQLSTATE_GENERAL_ERROR },
+	{ PDO_MIMER_FEATURE_NOT_IMPLEMENTED, PDO_MIMER_FEATURE_NOT_IMPLEMENTED, SQLSTATE_OPTIONAL_FEATURE_NOT_IMPLEMENTED },
+	{ PDO_MIMER_VALUE_TOO_LARGE,         PDO_MIMER_VALUE_TOO_LARGE,         SQLSTATE_NUMERIC_VALUE_OUT_OF_RANGE },
+	{ PDO_MIMER_ENC_STATEFUL,            PDO_MIMER_ENC_STATEFUL,            SQLSTATE_DATA_EXCEPTION },
+	{ PDO_MIMER_ENC_UNKNOWN,             PDO_MIMER_ENC_UNKNOWN,             SQLSTATE_DATA_EXCEPTION },
+	{ PDO_MIMER_UNKNOWN_LOB_TYPE,        PDO_MIMER_UNKNOWN_LOB_TYPE,        SQLSTATE_INVALID_SQL_DATA_TYPE },
+	{ PDO_MIMER_UNABLE_PHPSTREAM_ALLOC,  PDO_MIMER_UNABLE_PHPSTREAM_ALLOC,  SQLSTATE_MEMORY_ALLOCATION_ERROR },
+	{ PDO_MIMER_UNKNOWN_COLUMN_TYPE,     PDO_MIMER_UNKNOWN_COLUMN_TYPE,     SQLSTATE_INVALID_SQL_DATA_TYPE },
+	{ PDO_MIMER_QUERY_TIMEOUT,           PDO_MIMER_QUERY_TIMEOUT,           SQLSTATE_TIMEOUT_EXPIRED },
+	{ PDO_MIMER_UNSUPPORTED_ATTRIBUTE,   PDO_MIMER_UNSUPPORTED_ATTRIBUTE,   SQLSTATE_DRIVER_DOES_NOT_SUPPORT_FUNCTION },
+	{ PDO_MIMER_OUT_OF_MEMORY,           PDO_MIMER_OUT_OF_MEMORY,           SQLSTATE_MEMORY_ALLOCATION_ERROR },
+	{ PDO_MIMER_EMBEDDED_NUL,            PDO_MIMER_EMBEDDED_NUL,            SQLSTATE_INVALID_PARAMETER_VALUE },
+};
+
+/**
+ * @brief Maps the ranges of native error codes that belong to one class of errors to a SQLSTATE, used for codes
+ * without an entry of their own. Sorted on @p first, ranges do not overlap.
+ */
+static const pdo_mimer_sqlstate_map_entry pdo_mimer_sqlstate_ranges[] = {
+	{ MIMER_RC_COMMUNICATION_FIRST, MIMER_RC_COMMUNICATION_LAST, SQLSTATE_CONNECTION_FAILURE },
+	{ MIMER_RC_COMPILER_FIRST,      MIMER_RC_COMPILER_LAST,      SQLSTATE_SYNTAX_ERROR_OR_ACCESS_RULE_VIOLATION },
+	{ MIMER_RC_DATA_FIRST,          MIMER_RC_DATA_LAST,          SQLSTATE_DATA_EXCEPTION },
+	{ MIMER_RC_CONSTRAINT_FIRST,    MIMER_RC_CONSTRAINT_LAST,    SQLSTATE_INTEGRITY_CONSTRAINT_VIOLATION },
+};
+
+
+static int pdo_mimer_sqlstate_map_compare(const void *a, const void *b) {
+	MimerErrorCode first_a = ((const pdo_mimer_sqlstate_map_entry *) a)->first;
+	MimerErrorCode first_b = ((const pdo_mimer_sqlstate_map_entry *) b)->first;
+
+	return (first_a > first_b) - (first_a < first_b);
+}
+
+
+/**
+ * @brief Sorts the SQLSTATE mapping so that it can be binary searched, called once at module startup.
+ */
+void pdo_mimer_sqlstate_map_init(void) {
+	qsort(pdo_mimer_sqlstate_codes, sizeof(pdo_mimer_sqlstate_codes) / sizeof(pdo_mimer_sqlstate_codes[0]),
+		  sizeof(pdo_mimer_sqlstate_codes[0]), pdo_mimer_sqlstate_map_compare);
+}
+
+
+static const char *pdo_mimer_sqlstate_map_search(const pdo_mimer_sqlstate_map_entry *map, size_t map_len,
+												 MimerErrorCode error_code) {
+	size_t low = 0, high = map_len;
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		if (error_code < map[mid].first)
+			high = mid;
+		else if (error_code > map[mid].last)
+			low = mid + 1;
+		else
+			return map[mid].sqlstate;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Gets the SQLSTATE for a native Mimer SQL or PDO Mimer error code.
+ * @param error_code [in] The error code.
+ * @return The SQLSTATE, <code>SQLSTATE_GENERAL_ERROR</code> for codes that are not mapped.
+ */
 const char* pdo_mimer_get_sqlstate(MimerErrorCode error_code) {
-	switch (error_code) {
-		case MIMER_SUCCESS:
-			return SQLSTATE_SUCCESSFUL_COMPLETION;
-		case 90:
-			return SQLSTATE_CONNECTION_FAILURE;
-		default:
-			return SQLSTATE_GENERAL_ERROR;
+	const char *sqlstate;
+
+	if ((sqlstate = pdo_mimer_sqlstate_map_search(pdo_mimer_sqlstate_codes,
+			sizeof(pdo_mimer_sqlstate_codes) / sizeof(pdo_mimer_sqlstate_codes[0]), error_code)) != NULL)
+		return sqlstate;
+
+	if ((sqlstate = pdo_mimer_sqlstate_map_search(pdo_mimer_sqlstate_ranges,
+			sizeof(pdo_mimer_sqlstate_ranges) / sizeof(pdo_mimer_sqlstate_ranges[0]), error_code)) != NULL)
+		return sqlstate;
+
+	return SQLSTATE_GENERAL_ERROR;
+}
+
+
+/**
+ * @brief Checks if an error with the given SQLSTATE is worth retrying, i.e. the same work could succeed if redone.
+ * @param sqlstate [in] A SQLSTATE.
+ * @return true for transaction rollbacks (class 40), connection exceptions (class 08) and connection timeouts
+ * @return false otherwise, including a connection the server rejected since the same credentials would be rejected
+ * again, and a query timeout since the same query would run as long again
+ */
+bool pdo_mimer_sqlstate_is_transient(const char *sqlstate) {
+	return strncmp(sqlstate, "40", 2) == 0
+		|| (strncmp(sqlstate, "08", 2) == 0 && strcmp(sqlstate, SQLSTATE_SERVER_REJECTED_THE_CONNECTION) != 0)
+		|| strcmp(sqlstate, SQLSTATE_CONNECTION_TIMEOUT_EXPIRED) == 0;
+}
+
+
+/**
+ * @brief Makes sure the connection's reusable error message buffer can hold at least @p size bytes.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param size [in] The number of bytes needed, including the null-terminator.
+ * @return The message buffer.
+ */
+static char *pdo_mimer_error_msg_reserve(pdo_dbh_t *dbh, size_t size) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+	if (size > mimer_dbh->error.msg_size) {
+		size = MAX(size, PDO_MIMER_ERROR_MSG_MIN_SIZE);
+		mimer_dbh->error.msg = perealloc(mimer_dbh->error.msg, size, dbh->is_persistent);
+		mimer_dbh->error.msg_size = size;
 	}
+
+	return mimer_dbh->error.msg;
 }
 
 
 /**
- * @brief Error handler function to be used when an API error occurs. Gets the error code and error message.
+ * @brief Gets the message of the latest error, fetching it from Mimer SQL first if that has not been done yet.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @return The error message, owned by the connection and valid until the next error.
+ * @remark Must also be called before the handle that raised the error is used again or ended, since that replaces
+ * the message, see @ref pdo_mimer_error_from.
+ */
+const char *pdo_mimer_error_msg(pdo_dbh_t *dbh) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+	if (mimer_dbh->error.handle != NULL) {
+		MimerErrorCode error_code;
+		size_t msg_size = mimer_dbh->error.msg_len + 1;
+		char *msg = pdo_mimer_error_msg_reserve(dbh, msg_size);
+
+		if (!MIMER_SUCCEEDED(MimerGetError8(mimer_dbh->error.handle, &error_code, msg, msg_size)))
+			msg[0] = '\0';
+
+		mimer_dbh->error.handle = NULL;
+	}
+
+	return mimer_dbh->error.msg != NULL ? mimer_dbh->error.msg : "";
+}
+
+
+/**
+ * @brief Forgets the savepoints of a transaction which has ended.
+ * @param mimer_dbh [in] The Mimer connection.
+ */
+static void pdo_mimer_clear_savepoints(pdo_mimer_dbh *mimer_dbh) {
+	if (mimer_dbh->transaction.savepoints != NULL)
+		zend_hash_clean(mimer_dbh->transaction.savepoints);
+}
+
+
+/**
+ * @brief Error handler function to be used when an API error occurs. Gets the error code and SQLSTATE.
  * @param dbh [in] A pointer to the PDO database handle object.
  * @param stmt [in] A pointer to the PDOStatement handle object.
  * @param FILE [in] The name of the file where the error occurred, to be used with <code>__FILE__</code>.
  * @param LINE [in] The line number of where the error occurred, to be used with <code>__LINE__</code>.
  * @remark  If a @p dbh error, pass <code>NULL</code> to @p stmt. If a @p stmt error, pass @p stmt<code>->dbh</code>
  * to @p dbh and @p stmt to @p stmt.
+ * @remark The error message is not fetched here, only when it is asked for through @ref pdo_mimer_error_msg, since
+ * many errors are expected by the application and their message is never looked at.
  */
 void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE, const int LINE) {
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
 	pdo_mimer_stmt *mimer_stmt = stmt ? stmt->driver_data : NULL;
-	MimerHandle mimer_handle = mimer_stmt ? (MimerHandle) mimer_stmt->stmt : (MimerHandle) mimer_dbh->session;
 
-	if (mimer_dbh->error.msg != NULL) {
-		pefree(mimer_dbh->error.msg, dbh->is_persistent);
-		mimer_dbh->error.msg = NULL;
-	}
+	pdo_mimer_error_from(dbh, stmt,
+		mimer_stmt ? (MimerHandle) mimer_stmt->stmt : (MimerHandle) mimer_dbh->session, FILE, LINE);
+}
+
+
+/**
+ * @brief Sets an error raised by the driver itself rather than by the Mimer SQL C API.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param stmt [in] A pointer to the PDOStatement handle object, NULL for a @p dbh error.
+ * @param sqlstate [in] The SQLSTATE of the error.
+ * @param code [in] One of the PDO_MIMER_* return codes.
+ * @param msg [in] The error message.
+ */
+void pdo_mimer_set_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *sqlstate, MimerErrorCode code,
+	const char *msg) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+	size_t msg_size = strlen(msg) + 1;
+
+	memcpy(pdo_mimer_error_msg_reserve(dbh, msg_size), msg, msg_size);
+	mimer_dbh->error.code = code;
+	mimer_dbh->error.handle = NULL;
+	mimer_dbh->error.is_set = true;
+	strcpy(mimer_dbh->error.sqlstate, sqlstate);
+	strcpy(stmt ? stmt->error_code : dbh->error_code, sqlstate);
+
+	/* the server rolled the transaction back, its savepoints went with it */
+	if (!strncmp(sqlstate, "40", 2))
+		pdo_mimer_clear_savepoints(mimer_dbh);
+
+	if (PDO_MIMER_STATS_ENABLED())
+		pdo_mimer_stats_error(sqlstate);
+}
+
+
+/**
+ * @brief Like <code>pdo_mimer_error()</code>, but reads the error from the given handle, e.g. the read session.
+ */
+void pdo_mimer_error_from(pdo_dbh_t *dbh, pdo_stmt_t *stmt, MimerHandle mimer_handle, const char *FILE,
+	const int LINE) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
 
 	MimerReturnCode return_code = MimerGetError8(mimer_handle, &mimer_dbh->error.code, NULL, 0);
+	mimer_dbh->error.is_set = true;
 
-	char *err_msg;
 	if (!MIMER_SUCCEEDED(return_code)) {
-		spprintf(&err_msg, 0, "Unable to retrieve error information: %s:%d (%d)\n", FILE, LINE, return_code);
+		const char *format = "Unable to retrieve error information: %s:%d (%d)\n";
+		size_t msg_size = snprintf(NULL, 0, format, FILE, LINE, return_code) + 1;
+
+		snprintf(pdo_mimer_error_msg_reserve(dbh, msg_size), msg_size, format, FILE, LINE, return_code);
 		mimer_dbh->error.code = return_code;
+		mimer_dbh->error.handle = NULL;
 	} else {
-		size_t str_len = return_code + 1;
-		err_msg = emalloc(str_len);
-		MimerGetError8(mimer_handle, &mimer_dbh->error.code, err_msg, str_len);
+		mimer_dbh->error.handle = mimer_handle;
+		mimer_dbh->error.msg_len = return_code;
 	}
 
-	mimer_dbh->error.msg = pestrdup(err_msg, dbh->is_persistent);
 	strcpy(mimer_dbh->error.sqlstate, pdo_mimer_get_sqlstate(mimer_dbh->error.code));
-	efree(err_msg);
+	strcpy(stmt ? stmt->error_code : dbh->error_code, mimer_dbh->error.sqlstate);
 
-	strcpy(stmt ? stmt->error_code : dbh->error_code, pdo_mimer_get_sqlstate(mimer_dbh->error.code));
+	/* the server rolled the transaction back, its savepoints went with it */
+	if (!strncmp(mimer_dbh->error.sqlstate, "40", 2))
+		pdo_mimer_clear_savepoints(mimer_dbh);
+
+	if (PDO_MIMER_STATS_ENABLED())
+		pdo_mimer_stats_error(mimer_dbh->error.sqlstate);
 
 	if (!dbh->methods)
-		pdo_throw_exception(mimer_dbh->error.code, mimer_dbh->error.msg, &mimer_dbh->error.sqlstate);
+		pdo_throw_exception(mimer_dbh->error.code, (char *) pdo_mimer_error_msg(dbh), &mimer_dbh->error.sqlstate);
 }
 
+/**
+ * @brief Frees the connection's interned column names.
+ * @param mimer_dbh [in] The connection.
+ * @remark The names are request memory, also for persistent connections.
+ */
+static void pdo_mimer_free_column_names(pdo_mimer_dbh *mimer_dbh) {
+	if (mimer_dbh->column_names != NULL) {
+		zend_hash_destroy(mimer_dbh->column_names);
+		FREE_HASHTABLE(mimer_dbh->column_names);
+		mimer_dbh->column_names = NULL;
+	}
+}
+
+
 /**
  * @brief PDO method to end a Mimer SQL session.
  * @param dbh [in] A pointer to the PDO database handle object.
@@ -213,6 +435,28 @@ void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE, const i
 static void mimer_handle_closer(pdo_dbh_t *dbh) {
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
 
+    if (mimer_dbh->warmup.statements != NULL) {
+        zend_hash_destroy(mimer_dbh->warmup.statements);
+        pefree(mimer_dbh->warmup.statements, dbh->is_persistent);
+    }
+
+    if (mimer_dbh->rewrite_cache != NULL) {
+        zend_hash_destroy(mimer_dbh->rewrite_cache);
+        pefree(mimer_dbh->rewrite_cache, dbh->is_persistent);
+    }
+
+    pdo_mimer_free_column_names(mimer_dbh);
+
+    if (mimer_dbh->transaction.savepoints != NULL) {
+        zend_hash_destroy(mimer_dbh->transaction.savepoints);
+        pefree(mimer_dbh->transaction.savepoints, dbh->is_persistent);
+    }
+
+    pdo_mimer_async_free_pool(mimer_dbh, dbh->is_persistent);
+
+    if (mimer_dbh->read_session != MIMERNULLHANDLE && !MIMER_SUCCEEDED(MimerEndSession(&mimer_dbh->read_session)))
+        pdo_mimer_session_error(mimer_dbh->read_session);
+
     if (!MIMER_SUCCEEDED(MimerEndSession(&mimer_dbh->session))) {
         pdo_mimer_dbh_error();
 //        mimer_throw_except(dbh);
@@ -226,31 +470,164 @@ static void mimer_handle_closer(pdo_dbh_t *dbh) {
 }
 
 
-static char *pdo_mimer_rewrite_sql(pdo_stmt_t *stmt, zend_string *sql) {
+static void pdo_mimer_rewrite_entry_dtor(zval *entry) {
+	pdo_mimer_rewrite_entry *rewrite = Z_PTR_P(entry);
+
+	if (rewrite->sql != NULL)
+		zend_string_release(rewrite->sql);
+
+	for (uint32_t i = 0; i < rewrite->num_params; i++)
+		zend_string_release(rewrite->params[i].name);
+
+	pefree(rewrite, rewrite->is_persistent);
+}
+
+
+static void pdo_mimer_param_name_dtor(zval *name) {
+	zend_string_release(Z_PTR_P(name));
+}
+
+
+/**
+ * @brief Remembers how PDO rewrote a statement, so that the next prepare of the same SQL can skip the parser.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param stmt [in] A pointer to the PDOStatement handle object, holding the placeholder map built by PDO.
+ * @param sql [in] The SQL as given to <code>prepare()</code>.
+ * @param sql_rewritten [in] The rewritten SQL, or NULL if @p sql is sent as is. Ownership is taken.
+ * @return The cached entry.
+ */
+static pdo_mimer_rewrite_entry *pdo_mimer_cache_rewrite(pdo_dbh_t *dbh, pdo_stmt_t *stmt, zend_string *sql,
+														 zend_string *sql_rewritten) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+	uint32_t num_params = stmt->bound_param_map ? zend_hash_num_elements(stmt->bound_param_map) : 0;
+	pdo_mimer_rewrite_entry *rewrite;
+	zend_string *name;
+	zend_ulong position;
+
+	if (mimer_dbh->rewrite_cache == NULL) {
+		mimer_dbh->rewrite_cache = pemalloc(sizeof(HashTable), dbh->is_persistent);
+		zend_hash_init(mimer_dbh->rewrite_cache, 32, NULL, pdo_mimer_rewrite_entry_dtor, dbh->is_persistent);
+	} else if (zend_hash_num_elements(mimer_dbh->rewrite_cache) >= PDO_MIMER_REWRITE_CACHE_SIZE) {
+		zend_hash_clean(mimer_dbh->rewrite_cache);
+	}
+
+	rewrite = pemalloc(sizeof(pdo_mimer_rewrite_entry) + (num_params ? num_params - 1 : 0) * sizeof(rewrite->params[0]),
+					   dbh->is_persistent);
+	rewrite->is_persistent = dbh->is_persistent;
+	rewrite->num_params = 0;
+	rewrite->sql = sql_rewritten;
+
+	if (dbh->is_persistent && sql_rewritten != NULL) {
+		rewrite->sql = zend_string_dup(sql_rewritten, true);
+		GC_MAKE_PERSISTENT_LOCAL(rewrite->sql);
+		zend_string_release(sql_rewritten);
+	}
+
+	if (num_params > 0) {
+		ZEND_HASH_FOREACH_NUM_KEY_PTR(stmt->bound_param_map, position, name) {
+			name = dbh->is_persistent ? zend_string_dup(name, true) : zend_string_copy(name);
+			if (dbh->is_persistent)
+				GC_MAKE_PERSISTENT_LOCAL(name);
+
+			rewrite->params[rewrite->num_params].position = position;
+			rewrite->params[rewrite->num_params++].name = name;
+		} ZEND_HASH_FOREACH_END();
+	}
+
+	zend_hash_str_update_ptr(mimer_dbh->rewrite_cache, ZSTR_VAL(sql), ZSTR_LEN(sql), rewrite);
+	return rewrite;
+}
+
+
+/**
+ * @brief Rewrites named placeholders into the positional ones Mimer SQL understands.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @param sql [in] The SQL as given to <code>prepare()</code>.
+ * @return The SQL to send to Mimer SQL, or NULL upon failure.
+ * @remark The returned string is borrowed, it is either @p sql itself or owned by the connection's rewrite cache. The
+ * string is valid only until the next prepare on the connection, which may empty the cache; a caller which keeps it
+ * takes its own reference, as <code>pdo_mimer_create_stmt()</code> does until the statement is closed.
+ * @remark Statements without any <code>?</code> or <code>:</code> are passed through without being scanned, repeated
+ * prepares of the same SQL reuse the earlier rewrite and placeholder map instead of running
+ * <code>pdo_parse_params()</code> again.
+ */
+static zend_string *pdo_mimer_rewrite_sql(pdo_stmt_t *stmt, zend_string *sql) {
+	pdo_mimer_dbh *mimer_dbh = stmt->dbh->driver_data;
+	pdo_mimer_rewrite_entry *rewrite;
 	zend_string* sql_rewritten = NULL;
-	char *sql_str = NULL;
 
 	stmt->supports_placeholders = PDO_PLACEHOLDER_POSITIONAL;
-	switch (pdo_parse_params(stmt, sql, &sql_rewritten)) {
-		case FAILURE:
-			return NULL;
 
-		case SUCCESS:
-			return estrdup(ZSTR_VAL(sql));
+	if (memchr(ZSTR_VAL(sql), '?', ZSTR_LEN(sql)) == NULL && memchr(ZSTR_VAL(sql), ':', ZSTR_LEN(sql)) == NULL)
+		return sql;
 
-		default:
-			sql_str = estrdup(ZSTR_VAL(sql_rewritten));
-			zend_string_release(sql_rewritten);
-			return sql_str;
+	if (mimer_dbh->rewrite_cache == NULL || (rewrite = zend_hash_find_ptr(mimer_dbh->rewrite_cache, sql)) == NULL) {
+		switch (pdo_parse_params(stmt, sql, &sql_rewritten)) {
+			case FAILURE:
+				return NULL;
+
+			case SUCCESS:
+				rewrite = pdo_mimer_cache_rewrite(stmt->dbh, stmt, sql, NULL);
+				break;
+
+			default:
+				rewrite = pdo_mimer_cache_rewrite(stmt->dbh, stmt, sql, sql_rewritten);
+				break;
+		}
+
+	} else if (rewrite->num_params > 0) {
+		ALLOC_HASHTABLE(stmt->bound_param_map);
+		zend_hash_init(stmt->bound_param_map, rewrite->num_params, NULL, pdo_mimer_param_name_dtor, false);
+
+		for (uint32_t i = 0; i < rewrite->num_params; i++)
+			zend_hash_index_update_ptr(stmt->bound_param_map, rewrite->params[i].position,
+									   zend_string_copy(rewrite->params[i].name));
 	}
+
+	return rewrite->sql ? rewrite->sql : sql;
+}
+
+
+/**
+ * @brief Hands over a statement that was prepared during warm-up, if one matches the SQL.
+ * @param mimer_dbh [in] A pointer to the PDO Mimer database handle object.
+ * @param sql [in] The SQL statement, as sent to <code>MimerBeginStatement8</code>.
+ * @return The warmed <code>MimerStatement</code>, or <code>MIMERNULLHANDLE</code> if there is none.
+ * @remark The caller takes ownership of the returned statement, each warmed statement is handed out only once.
+ */
+static MimerStatement pdo_mimer_take_warm_statement(pdo_mimer_dbh *mimer_dbh, zend_string *sql) {
+	MimerStatement statement;
+	zval *entry;
+
+	if (mimer_dbh->warmup.statements == NULL || (entry = zend_hash_find(mimer_dbh->warmup.statements, sql)) == NULL)
+		return MIMERNULLHANDLE;
+
+	statement = Z_PTR_P(entry);
+	ZVAL_PTR(entry, NULL); /* keep the destructor from ending the statement */
+	zend_hash_del(mimer_dbh->warmup.statements, sql);
+
+	mimer_dbh->warmup.used++;
+	PDO_MIMER_STATS_INC(stmt_cache_hits);
+	return statement;
 }
 
 
-static pdo_mimer_stmt *pdo_mimer_create_stmt(pdo_dbh_t *dbh, MimerStatement statement, int32_t cursor_type) {
+static pdo_mimer_stmt *pdo_mimer_create_stmt(pdo_dbh_t *dbh, MimerStatement statement, zend_string *sql,
+	int32_t cursor_type, bool is_read_query, bool is_on_read_session) {
 	pdo_mimer_stmt *mimer_stmt = emalloc(sizeof(pdo_mimer_stmt));
 	*mimer_stmt = (pdo_mimer_stmt) {
 		.dbh  = dbh->driver_data,
 		.stmt = statement,
+		.sql  = zend_string_copy(sql),
+		.is_read_query      = is_read_query,
+		.is_on_read_session = is_on_read_session,
+		.routes     = {
+			.primary = is_on_read_session ? MIMERNULLHANDLE : statement,
+			.read    = is_on_read_session ? statement : MIMERNULLHANDLE,
+		},
+		.limits     = {
+			.timeout = ((pdo_mimer_dbh *) dbh->driver_data)->query_timeout,
+		},
 		.cursor     = {
 			.is_open       = false,
 			.is_scrollable = cursor_type == MIMER_SCROLLABLE,
@@ -262,21 +639,59 @@ static pdo_mimer_stmt *pdo_mimer_create_stmt(pdo_dbh_t *dbh, MimerStatement stat
 
 
 /**
- * @brief PDO method to prepare a SQL query with possible positional or named placeholders.
+ * @brief Tells whether a query may be run on the read session.
+ * @param sql [in] The SQL statement as it will be sent.
+ * @return true for a <code>SELECT</code>, <code>WITH</code> or <code>VALUES</code> statement which does not lock rows
+ * for an update
+ * @return false for anything else
+ */
+static bool pdo_mimer_is_read_query(zend_string *sql) {
+	const char *p = ZSTR_VAL(sql), *end = p + ZSTR_LEN(sql);
+
+	while (p < end && (isspace((unsigned char) *p) || *p == '('))
+		p++;
+
+#define PDO_MIMER_KEYWORD(kw) ((size_t) (end - p) > sizeof(kw) - 1 && !strncasecmp(p, kw, sizeof(kw) - 1) && \
+	!isalnum((unsigned char) p[sizeof(kw) - 1]) && p[sizeof(kw) - 1] != '_')
+	if (!PDO_MIMER_KEYWORD("SELECT") && !PDO_MIMER_KEYWORD("WITH") && !PDO_MIMER_KEYWORD("VALUES"))
+		return false;
+#undef PDO_MIMER_KEYWORD
+
+	return zend_memnistr(p, "FOR UPDATE", sizeof("FOR UPDATE") - 1, end) == NULL;
+}
+
+
+/**
+ * @brief Tells whether read queries currently go to the read session.
  * @param dbh [in] A pointer to the PDO database handle object.
- * @param sql [in] The SQL query to be executed.
- * @param stmt [in|out] A pointer to the PDOStatement handle object.
- * @param driver_options [in] User-specified options to Mimer SQL.
- * @return true upon success
- * @return false upon failure
+ * @return true if a read session has been configured and a query cannot be part of a read-write transaction: either no
+ * transaction is active and autocommit is on, or the transaction option is read-only
+ * @return false if queries belong on the primary session
+ * @remark This changes with the transaction state, so a statement asks again each time it is executed.
  */
-static bool mimer_handle_preparer(pdo_dbh_t *dbh, zend_string *sql, pdo_stmt_t *stmt, zval *driver_options) {
+bool pdo_mimer_reads_may_route(pdo_dbh_t *dbh) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+	if (mimer_dbh->read_session == MIMERNULLHANDLE)
+		return false;
+
+	return mimer_dbh->transaction.is_read_only ||
+		(!mimer_dbh->transaction.is_in_transaction && dbh->auto_commit);
+}
+
+
+/**
+ * @brief Prepares a SQL query with possible positional or named placeholders, see <code>mimer_handle_preparer()</code>.
+ */
+static bool pdo_mimer_prepare(pdo_dbh_t *dbh, zend_string *sql, pdo_stmt_t *stmt, zval *driver_options) {
     MimerReturnCode return_code = MIMER_SUCCESS;
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
     MimerStatement statement = MIMERNULLHANDLE;
 
-	char *sql_str = pdo_mimer_rewrite_sql(stmt, sql);
-	if (sql_str == NULL) {
+	pdo_mimer_claim_sessions(mimer_dbh);
+
+	zend_string *sql_rewritten = pdo_mimer_rewrite_sql(stmt, sql);
+	if (sql_rewritten == NULL) {
 		strcpy(dbh->error_code, stmt->error_code);
 		return false;
 	}
@@ -285,18 +700,50 @@ static bool mimer_handle_preparer(pdo_dbh_t *dbh, zend_string *sql, pdo_stmt_t *
 	int32_t cursor_type = pdo_attr_lval(driver_options, PDO_ATTR_CURSOR, PDO_CURSOR_FWDONLY) ==
 		PDO_CURSOR_SCROLL ? MIMER_SCROLLABLE : MIMER_FORWARD_ONLY;
 
-	if (!MIMER_SUCCEEDED(return_code = MimerBeginStatement8(mimer_dbh->session, sql_str, cursor_type, &statement))) {
-		pdo_mimer_dbh_error();
-		goto cleanup;
+	bool is_read_query = mimer_dbh->read_session != MIMERNULLHANDLE && pdo_mimer_is_read_query(sql_rewritten);
+	bool is_on_read_session = is_read_query && pdo_mimer_reads_may_route(dbh);
+
+	if (cursor_type == MIMER_FORWARD_ONLY && !is_on_read_session)
+		statement = pdo_mimer_take_warm_statement(mimer_dbh, sql_rewritten);
+
+	if (statement == MIMERNULLHANDLE && !MIMER_SUCCEEDED(return_code = MimerBeginStatement8(
+		is_on_read_session ? mimer_dbh->read_session : mimer_dbh->session, ZSTR_VAL(sql_rewritten), cursor_type,
+		&statement))) {
+		pdo_mimer_session_error(is_on_read_session ? mimer_dbh->read_session : mimer_dbh->session);
+		return false;
 	}
 
-    stmt->driver_data = pdo_mimer_create_stmt(dbh, statement, cursor_type);
+    stmt->driver_data = pdo_mimer_create_stmt(dbh, statement, sql_rewritten, cursor_type, is_read_query,
+		is_on_read_session);
+
+	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+	mimer_stmt->limits.fetch_size = (int32_t) pdo_attr_lval(driver_options, MIMER_ATTR_FETCH_SIZE, 0);
+	mimer_stmt->limits.max_rows = pdo_attr_lval(driver_options, MIMER_ATTR_MAX_ROWS, 0);
+	mimer_stmt->limits.timeout = pdo_attr_lval(driver_options, MIMER_ATTR_QUERY_TIMEOUT, mimer_dbh->query_timeout);
+	pdo_mimer_strings_init(&mimer_stmt->strings, driver_options != NULL ? Z_ARRVAL_P(driver_options) : NULL);
+	mimer_stmt->prefetch.rows = MAX(pdo_attr_lval(driver_options, MIMER_ATTR_PREFETCH_ROWS, 0), 0);
     stmt->methods = &pdo_mimer_stmt_methods;
 
-    cleanup:
-    efree(sql_str);
+    return true;
+}
 
-    return MIMER_SUCCEEDED(return_code);
+
+/**
+ * @brief PDO method to prepare a SQL query with possible positional or named placeholders.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param sql [in] The SQL query to be executed.
+ * @param stmt [in|out] A pointer to the PDOStatement handle object.
+ * @param driver_options [in] User-specified options to Mimer SQL.
+ * @return true upon success
+ * @return false upon failure
+ */
+static bool mimer_handle_preparer(pdo_dbh_t *dbh, zend_string *sql, pdo_stmt_t *stmt, zval *driver_options) {
+	uint64_t started = pdo_mimer_stats_start();
+	bool success = pdo_mimer_prepare(dbh, sql, stmt, driver_options);
+
+	PDO_MIMER_STATS_INC(prepares);
+	PDO_MIMER_STATS_TIME(prepare_ns, started);
+	return success;
 }
 
 
@@ -311,7 +758,18 @@ static bool mimer_handle_preparer(pdo_dbh_t *dbh, zend_string *sql, pdo_stmt_t *
 static zend_long mimer_handle_doer(pdo_dbh_t *dbh, const zend_string *sql) {
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
 
-    if (!MIMER_SUCCEEDED(MimerExecuteStatement8(mimer_dbh->session, ZSTR_VAL(sql)))) {
+	pdo_mimer_claim_sessions(mimer_dbh);
+
+	if (!pdo_mimer_ensure_transaction(dbh))
+		return FAILURE;
+
+	uint64_t started = pdo_mimer_stats_start();
+	MimerReturnCode return_code = MimerExecuteStatement8(mimer_dbh->session, ZSTR_VAL(sql));
+
+	PDO_MIMER_STATS_INC(executes);
+	PDO_MIMER_STATS_TIME(execute_ns, started);
+
+    if (!MIMER_SUCCEEDED(return_code)) {
         pdo_mimer_dbh_error();
         return FAILURE;
     }
@@ -362,32 +820,91 @@ static zend_string* mimer_handle_quoter(pdo_dbh_t *dbh, const zend_string *unquo
 }
 
 
+/**
+ * @brief Starts a transaction on the server.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param read_only [in] Whether the transaction is read-only.
+ * @return true if transaction was started
+ * @return false if unable to start transaction
+ */
+static bool pdo_mimer_begin_transaction(pdo_dbh_t *dbh, bool read_only) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+	pdo_mimer_claim_sessions(mimer_dbh);
+
+	if (!MIMER_SUCCEEDED(MimerBeginTransaction(mimer_dbh->session,
+		read_only ? MIMER_TRANS_READONLY : MIMER_TRANS_READWRITE))) {
+		pdo_mimer_dbh_error();
+		return false;
+	}
+
+	mimer_dbh->transaction.is_in_transaction = true;
+	return true;
+}
+
+
 static bool mimer_handle_transaction(pdo_dbh_t *dbh, bool start_transaction, int32_t transaction_op) {
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
-	MimerReturnCode return_code = MIMER_SUCCESS;
+
+	pdo_mimer_claim_sessions(mimer_dbh);
 
 	if (start_transaction) {
-		transaction_op = mimer_dbh->transaction.is_read_only ? MIMER_TRANS_READONLY : MIMER_TRANS_READWRITE;
-		return_code = MimerBeginTransaction(mimer_dbh->session, transaction_op);
-	} else {
-		return_code = MimerEndTransaction(mimer_dbh->session, transaction_op);
+		if (!mimer_dbh->transaction.is_deferred)
+			return pdo_mimer_begin_transaction(dbh, mimer_dbh->transaction.is_read_only);
+
+		mimer_dbh->transaction.is_begin_pending = true;
+		mimer_dbh->transaction.is_pending_read_only = mimer_dbh->transaction.is_read_only;
+		mimer_dbh->transaction.is_in_transaction = true;
+		return true;
 	}
 
-	if (!MIMER_SUCCEEDED(return_code)) {
+	/* nothing was executed in a pending transaction, there is nothing to end on the server */
+	if (!mimer_dbh->transaction.is_begin_pending && !MIMER_SUCCEEDED(MimerEndTransaction(mimer_dbh->session,
+		transaction_op))) {
 		pdo_mimer_dbh_error();
 		return false;
 	}
 
-	mimer_dbh->transaction.is_in_transaction = start_transaction;
+	pdo_mimer_clear_savepoints(mimer_dbh);
+	mimer_dbh->transaction.is_begin_pending = false;
+	mimer_dbh->transaction.is_in_transaction = false;
 	return true;
 }
 
 
+/**
+ * @brief Starts the transaction a statement runs in: the pending one if beginTransaction() was deferred, or a new one
+ * when autocommit is off and no transaction is active yet.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @return true if a transaction is active or none is needed
+ * @return false if unable to start transaction
+ * @remark Called before anything is executed, the transaction then lasts until an explicit commit or rollback.
+ */
+bool pdo_mimer_ensure_transaction(pdo_dbh_t *dbh) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+	if (mimer_dbh->transaction.is_begin_pending) {
+		if (!pdo_mimer_begin_transaction(dbh, mimer_dbh->transaction.is_pending_read_only))
+			return false;
+
+		mimer_dbh->transaction.is_begin_pending = false;
+		return true;
+	}
+
+	if (dbh->auto_commit || mimer_dbh->transaction.is_in_transaction)
+		return true;
+
+	return pdo_mimer_begin_transaction(dbh, mimer_dbh->transaction.is_read_only);
+}
+
+
 /**
  * @brief PDO method to start a transaction.
  * @param dbh [in] A pointer to the PDO database handle object.
  * @return true if transaction was started
  * @return false if unable to start transaction
+ * @remark With <code>PDO::MIMER_ATTR_DEFERRED_BEGIN</code> set, the transaction is only started on the server by the
+ * first statement executed in it, and committing or rolling back a transaction where nothing was executed costs nothing.
  */
 static bool mimer_handle_begin(pdo_dbh_t *dbh) {
     return mimer_handle_transaction(dbh, true, MIMER_TRANS_DEFAULT);
@@ -438,6 +955,43 @@ static bool pdo_mimer_set_attribute(pdo_dbh_t *dbh, zend_long attribute, zval *v
             return true;
         }
 
+        case MIMER_ATTR_DEFERRED_BEGIN: {
+            bool deferred;
+            if (!pdo_get_bool_param(&deferred, value))
+                return false;
+
+            mimer_dbh->transaction.is_deferred = deferred;
+            return true;
+        }
+
+        case MIMER_ATTR_QUERY_TIMEOUT: {
+            zend_long timeout;
+            if (!pdo_get_long_param(&timeout, value))
+                return false;
+
+            if (timeout < 0) {
+                zend_value_error("Attribute value must be greater than or equal to 0");
+                return false;
+            }
+
+            mimer_dbh->query_timeout = timeout;
+            return true;
+        }
+
+        case PDO_ATTR_AUTOCOMMIT: {
+            bool auto_commit;
+            if (!pdo_get_bool_param(&auto_commit, value))
+                return false;
+
+            /* switching autocommit back on commits the work done so far, as the next statement would */
+            if (auto_commit && !dbh->auto_commit && mimer_dbh->transaction.is_in_transaction &&
+                !mimer_handle_transaction(dbh, false, MIMER_COMMIT))
+                return false;
+
+            dbh->auto_commit = auto_commit;
+            return true;
+        }
+
         default:
             return false;
     }
@@ -453,13 +1007,13 @@ static bool pdo_mimer_set_attribute(pdo_dbh_t *dbh, zend_long attribute, zval *v
 static void pdo_mimer_fetch_err(pdo_dbh_t *dbh, pdo_stmt_t *stmt, zval *info) {
     pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
 
-    if (mimer_dbh->error.msg == NULL) {
+    if (!mimer_dbh->error.is_set) {
         add_next_index_null(info);
         return;
     }
 
     add_next_index_long(info, mimer_dbh->error.code);
-    add_next_index_string(info, mimer_dbh->error.msg);
+    add_next_index_string(info, pdo_mimer_error_msg(dbh));
 }
 
 
@@ -472,6 +1026,8 @@ static void pdo_mimer_fetch_err(pdo_dbh_t *dbh, pdo_stmt_t *stmt, zval *info) {
 static zend_result pdo_mimer_check_liveness(pdo_dbh_t *dbh) {
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
 
+    pdo_mimer_claim_sessions(mimer_dbh);
+
     if (!MIMER_SUCCEEDED(MimerPing(mimer_dbh->session))) {
         pdo_mimer_dbh_error();
         return FAILURE;
@@ -502,6 +1058,10 @@ static int pdo_mimer_get_attribute(pdo_dbh_t *dbh, zend_long attribute, zval *re
             ZVAL_STRING(return_value, "mimer");
             break;
 
+        case PDO_ATTR_AUTOCOMMIT:
+            ZVAL_BOOL(return_value, dbh->auto_commit);
+            break;
+
         case PDO_ATTR_CONNECTION_STATUS: {
             if (pdo_mimer_check_liveness(dbh) == FAILURE) {
                 ZVAL_STRING(return_value, "Disconnected");
@@ -517,6 +1077,29 @@ static int pdo_mimer_get_attribute(pdo_dbh_t *dbh, zend_long attribute, zval *re
             ZVAL_STRING(return_value, mimer_dbh->transaction.is_read_only ? "Read-only" : "Read and write");
             break;
 
+        case MIMER_ATTR_WARMUP_STATS:
+            array_init(return_value);
+            add_assoc_long(return_value, "prepared", mimer_dbh->warmup.prepared);
+            add_assoc_long(return_value, "failed", mimer_dbh->warmup.failed);
+            add_assoc_long(return_value, "used", mimer_dbh->warmup.used);
+            add_assoc_double(return_value, "time_ms", mimer_dbh->warmup.time_ns / 1e6);
+            break;
+
+        case MIMER_ATTR_DEFERRED_BEGIN:
+            ZVAL_BOOL(return_value, mimer_dbh->transaction.is_deferred);
+            break;
+
+        case MIMER_ATTR_QUERY_TIMEOUT:
+            ZVAL_LONG(return_value, mimer_dbh->query_timeout);
+            break;
+
+        case MIMER_ATTR_RETRY_STATS:
+            array_init(return_value);
+            add_assoc_long(return_value, "transactions", mimer_dbh->retry.transactions);
+            add_assoc_long(return_value, "retries", mimer_dbh->retry.retries);
+            add_assoc_long(return_value, "conflicts", mimer_dbh->retry.conflicts);
+            break;
+
         default:
             return 0;
     }
@@ -532,7 +1115,468 @@ static int pdo_mimer_get_attribute(pdo_dbh_t *dbh, zend_long attribute, zval *re
  * @return An array of methods or NULL if no methods available.
  */
 static const zend_function_entry *pdo_mimer_get_driver_methods(pdo_dbh_t *dbh, int kind) {
-    return kind == PDO_DBH_DRIVER_METHOD_KIND_STMT ? class_PDOStatement_MimerSQL_Ext_methods : NULL;
+    switch (kind) {
+        case PDO_DBH_DRIVER_METHOD_KIND_DBH:
+            return class_PDO_MimerSQL_Ext_methods;
+        case PDO_DBH_DRIVER_METHOD_KIND_STMT:
+            return class_PDOStatement_MimerSQL_Ext_methods;
+        default:
+            return NULL;
+    }
+}
+
+
+/**
+ * @brief Reads the SQLSTATE behind a <code>PDOException</code>.
+ * @param exception [in] The exception object.
+ * @param sqlstate [out] Buffer of at least six characters receiving the null-terminated SQLSTATE.
+ * @return true if the exception carries an SQLSTATE
+ * @return false if it does not
+ */
+static bool pdo_mimer_exception_sqlstate(zend_object *exception, char *sqlstate) {
+    zval *error_info, *state = NULL, rv_info, rv_code;
+
+    error_info = zend_read_property(php_pdo_get_exception(), exception, "errorInfo", sizeof("errorInfo")-1, true,
+                                    &rv_info);
+    if (Z_TYPE_P(error_info) == IS_ARRAY)
+        state = zend_hash_index_find(Z_ARRVAL_P(error_info), 0);
+
+    /* errorInfo is not set on exceptions raised by PDO itself, the SQLSTATE is then only found in the code */
+    if (state == NULL || Z_TYPE_P(state) != IS_STRING)
+        state = zend_read_property(zend_ce_exception, exception, "code", sizeof("code")-1, true, &rv_code);
+
+    if (Z_TYPE_P(state) != IS_STRING || Z_STRLEN_P(state) != 5)
+        return false;
+
+    memcpy(sqlstate, Z_STRVAL_P(state), 6);
+    return true;
+}
+
+
+/**
+ * @brief The PHP method <code>mimerIsTransient()</code> extends the <code>PDO</code> class to tell whether the
+ * error behind a <code>PDOException</code> is transient, so that the failed work can be retried.
+ * @param return_value [out] true if the SQLSTATE of the exception is a transaction rollback, a connection exception or
+ * a timeout, false otherwise.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerIsTransient) {
+    zval *exception;
+    char sqlstate[6];
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_OBJECT_OF_CLASS(exception, php_pdo_get_exception())
+    ZEND_PARSE_PARAMETERS_END();
+
+    RETURN_BOOL(pdo_mimer_exception_sqlstate(Z_OBJ_P(exception), sqlstate) && pdo_mimer_sqlstate_is_transient(sqlstate));
+}
+
+
+/**
+ * @brief Reads an integer option from a user supplied options array.
+ * @param options [in] The options array, may be NULL.
+ * @param name [in] The key of the option.
+ * @param default_value [in] The value to use when the option is not given.
+ * @return The value of the option.
+ */
+zend_long pdo_mimer_option_long(HashTable *options, const char *name, zend_long default_value) {
+    zval *value;
+
+    if (options == NULL || (value = zend_hash_str_find(options, name, strlen(name))) == NULL)
+        return default_value;
+
+    return zval_get_long(value);
+}
+
+
+/**
+ * @brief Reads a boolean option from a user supplied options array.
+ * @param options [in] The options array, may be NULL.
+ * @param name [in] The key of the option.
+ * @param default_value [in] The value to use when the option is not given.
+ * @return The value of the option.
+ */
+bool pdo_mimer_option_bool(HashTable *options, const char *name, bool default_value) {
+    zval *value;
+
+    if (options == NULL || (value = zend_hash_str_find(options, name, strlen(name))) == NULL)
+        return default_value;
+
+    return zend_is_true(value);
+}
+
+
+/**
+ * @brief Sleeps before the next attempt of a conflicting transaction.
+ * @param attempt [in] The number of the attempt that failed, starting at 1.
+ * @param backoff_ms [in] The delay after the first attempt.
+ * @param max_backoff_ms [in] Upper bound of the delay.
+ * @remark The delay doubles per attempt and half of it is random, so that sessions which collided do not retry in
+ * lockstep and collide again.
+ */
+static void pdo_mimer_retry_backoff(zend_long attempt, zend_long backoff_ms, zend_long max_backoff_ms) {
+    uint64_t delay_ms = backoff_ms, seed = pdo_mimer_hrtime();
+
+    while (--attempt > 0 && delay_ms < (uint64_t) max_backoff_ms)
+        delay_ms <<= 1;
+    if (delay_ms > (uint64_t) max_backoff_ms)
+        delay_ms = max_backoff_ms;
+    if (delay_ms == 0)
+        return;
+
+    /* xorshift is plenty for jitter and keeps the user's mt_rand() sequence untouched */
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    delay_ms = delay_ms / 2 + seed % (delay_ms / 2 + 1);
+
+#ifdef PHP_WIN32
+    Sleep((DWORD) delay_ms);
+#else
+    usleep((useconds_t) (delay_ms * 1000));
+#endif
+}
+
+
+/**
+ * @brief Ends a transaction whose commit failed. The server has already rolled it back on a conflict, the rollback
+ * only brings the session back into a known state and its outcome is of no interest.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ */
+static void pdo_mimer_abandon_transaction(pdo_dbh_t *dbh) {
+    pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+    pdo_mimer_claim_sessions(mimer_dbh);
+    /* the rollback replaces the message of the error that made the work fail, it is still to be reported */
+    pdo_mimer_error_msg(dbh);
+    if (!mimer_dbh->transaction.is_begin_pending)
+        MimerEndTransaction(mimer_dbh->session, MIMER_ROLLBACK);
+    pdo_mimer_clear_savepoints(mimer_dbh);
+    mimer_dbh->transaction.is_begin_pending = false;
+    mimer_dbh->transaction.is_in_transaction = false;
+}
+
+
+/**
+ * @brief The PHP method <code>mimerTransaction()</code> extends the <code>PDO</code> class to run a unit of work in a
+ * transaction and replay it when Mimer SQL's optimistic concurrency control rejects it.
+ * @param return_value [out] What the callable returned, false if the transaction could not be started or committed.
+ * @remark The callable receives the <code>PDO</code> object. Only errors of SQLSTATE class 40 (transaction rollback)
+ * are retried, anything else is rethrown or reported after rolling back. The options <code>attempts</code>,
+ * <code>backoff_ms</code> and <code>max_backoff_ms</code> bound the retry loop.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerTransaction) {
+    pdo_dbh_t *dbh = Z_PDO_DBH_P(ZEND_THIS);
+    pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+    zend_fcall_info fci;
+    zend_fcall_info_cache fcc;
+    HashTable *options = NULL;
+    zend_long attempts, backoff_ms, max_backoff_ms;
+    zval args[1], retval;
+    char sqlstate[6];
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_FUNC(fci, fcc)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_ARRAY_HT(options)
+    ZEND_PARSE_PARAMETERS_END();
+
+    attempts = pdo_mimer_option_long(options, "attempts", PDO_MIMER_RETRY_ATTEMPTS);
+    backoff_ms = pdo_mimer_option_long(options, "backoff_ms", PDO_MIMER_RETRY_BACKOFF_MS);
+    max_backoff_ms = pdo_mimer_option_long(options, "max_backoff_ms", PDO_MIMER_RETRY_MAX_BACKOFF_MS);
+
+    if (attempts < 1) {
+        zend_argument_value_error(2, "option \"attempts\" must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (backoff_ms < 0 || max_backoff_ms < 0) {
+        zend_argument_value_error(2, "backoff options must be greater than or equal to 0");
+        RETURN_THROWS();
+    }
+
+    if (mimer_dbh->transaction.is_in_transaction) {
+        zend_throw_exception_ex(php_pdo_get_exception(), 0, "There is already an active transaction");
+        RETURN_THROWS();
+    }
+
+    ZVAL_OBJ(&args[0], Z_OBJ_P(ZEND_THIS));
+    fci.params = args;
+    fci.param_count = 1;
+    fci.retval = &retval;
+    mimer_dbh->retry.transactions++;
+
+    for (zend_long attempt = 1; ; attempt++) {
+        strcpy(dbh->error_code, PDO_ERR_NONE);
+        if (!mimer_handle_transaction(dbh, true, MIMER_TRANS_DEFAULT)) {
+            pdo_handle_error(dbh, NULL);
+            RETURN_FALSE;
+        }
+
+        ZVAL_UNDEF(&retval);
+        if (zend_call_function(&fci, &fcc) == FAILURE || EG(exception)) {
+            bool conflict = EG(exception) && instanceof_function(EG(exception)->ce, php_pdo_get_exception()) &&
+                            pdo_mimer_exception_sqlstate(EG(exception), sqlstate) && !strncmp(sqlstate, "40", 2);
+
+            zval_ptr_dtor(&retval);
+            if (mimer_dbh->transaction.is_in_transaction)
+                pdo_mimer_abandon_transaction(dbh);
+
+            if (conflict)
+                mimer_dbh->retry.conflicts++;
+            if (!conflict || attempt >= attempts)
+                RETURN_THROWS();
+
+            zend_clear_exception();
+        } else if (!mimer_dbh->transaction.is_in_transaction || mimer_handle_transaction(dbh, false, MIMER_COMMIT)) {
+            /* the callable may have ended the transaction itself, its decision stands */
+            RETURN_COPY_VALUE(&retval);
+        } else {
+            bool conflict = !strncmp(dbh->error_code, "40", 2);
+
+            zval_ptr_dtor(&retval);
+            pdo_mimer_abandon_transaction(dbh);
+
+            if (conflict)
+                mimer_dbh->retry.conflicts++;
+            if (!conflict || attempt >= attempts) {
+                pdo_handle_error(dbh, NULL);
+                RETURN_FALSE;
+            }
+        }
+
+        mimer_dbh->retry.retries++;
+        pdo_mimer_retry_backoff(attempt, backoff_ms, max_backoff_ms);
+    }
+}
+
+
+typedef enum {
+    PDO_MIMER_SAVEPOINT_SET,
+    PDO_MIMER_SAVEPOINT_ROLLBACK,
+    PDO_MIMER_SAVEPOINT_RELEASE,
+} pdo_mimer_savepoint_op;
+
+
+/**
+ * @brief Sets, rolls back to or releases a savepoint and keeps the connection's list of savepoints in step.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param name [in] The name of the savepoint, sent as a delimited identifier.
+ * @param op [in] What to do with the savepoint.
+ * @return true upon success
+ * @return false upon failure, the error is reported according to the error mode
+ * @remark Rolling back to a savepoint keeps it and discards the ones set after it, releasing it discards it as well.
+ * Setting a savepoint with autocommit off or a deferred begin starts the transaction, like any other statement.
+ */
+static bool pdo_mimer_savepoint(pdo_dbh_t *dbh, zend_string *name, pdo_mimer_savepoint_op op) {
+    static const char *verbs[] = { "SAVEPOINT \"", "ROLLBACK TO SAVEPOINT \"", "RELEASE SAVEPOINT \"" };
+    pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+    HashTable *savepoints;
+    zend_string *key;
+    smart_str sql = {0};
+    bool success;
+
+    strcpy(dbh->error_code, PDO_ERR_NONE);
+    pdo_mimer_claim_sessions(mimer_dbh);
+
+    if (op == PDO_MIMER_SAVEPOINT_SET && !pdo_mimer_ensure_transaction(dbh)) {
+        pdo_handle_error(dbh, NULL);
+        return false;
+    }
+
+    if (!mimer_dbh->transaction.is_in_transaction) {
+        zend_throw_exception_ex(php_pdo_get_exception(), 0, "There is no active transaction");
+        return false;
+    }
+
+    if (mimer_dbh->transaction.savepoints == NULL) {
+        mimer_dbh->transaction.savepoints = pemalloc(sizeof(HashTable), dbh->is_persistent);
+        zend_hash_init(mimer_dbh->transaction.savepoints, 8, NULL, NULL, dbh->is_persistent);
+    }
+    savepoints = mimer_dbh->transaction.savepoints;
+
+    if (op != PDO_MIMER_SAVEPOINT_SET && !zend_hash_exists(savepoints, name)) {
+        pdo_raise_impl_error(dbh, NULL, SQLSTATE_INVALID_SAVEPOINT_SPECIFICATION, "savepoint does not exist");
+        return false;
+    }
+
+    smart_str_appends(&sql, verbs[op]);
+    for (size_t i = 0; i < ZSTR_LEN(name); i++) {
+        if (ZSTR_VAL(name)[i] == '"')
+            smart_str_appendc(&sql, '"');
+        smart_str_appendc(&sql, ZSTR_VAL(name)[i]);
+    }
+    smart_str_appendc(&sql, '"');
+    smart_str_0(&sql);
+
+    success = MIMER_SUCCEEDED(MimerExecuteStatement8(mimer_dbh->session, ZSTR_VAL(sql.s)));
+    smart_str_free(&sql);
+
+    if (!success) {
+        pdo_mimer_dbh_error();
+        pdo_handle_error(dbh, NULL);
+        return false;
+    }
+
+    /* a savepoint set again under the same name replaces the old one, and moves to the end of the list */
+    ZEND_HASH_REVERSE_FOREACH_STR_KEY(savepoints, key) {
+        if (zend_string_equals(key, name)) {
+            if (op != PDO_MIMER_SAVEPOINT_ROLLBACK)
+                zend_hash_del(savepoints, key);
+            break;
+        }
+        if (op != PDO_MIMER_SAVEPOINT_SET)
+            zend_hash_del(savepoints, key);
+    } ZEND_HASH_FOREACH_END();
+
+    if (op == PDO_MIMER_SAVEPOINT_SET)
+        zend_hash_str_add_empty_element(savepoints, ZSTR_VAL(name), ZSTR_LEN(name));
+
+    return true;
+}
+
+
+/**
+ * @brief Common implementation of the savepoint methods, which take the savepoint name as their only argument.
+ */
+static void pdo_mimer_savepoint_method(INTERNAL_FUNCTION_PARAMETERS, pdo_mimer_savepoint_op op) {
+    zend_string *name;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(name)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (ZSTR_LEN(name) == 0) {
+        zend_argument_value_error(1, "cannot be empty");
+        RETURN_THROWS();
+    }
+
+    RETURN_BOOL(pdo_mimer_savepoint(Z_PDO_DBH_P(ZEND_THIS), name, op));
+}
+
+
+/**
+ * @brief The PHP method <code>mimerSavepoint()</code> extends the <code>PDO</code> class to set a savepoint in the
+ * current transaction.
+ * @param return_value [out] true upon success, false upon failure.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerSavepoint) {
+    pdo_mimer_savepoint_method(INTERNAL_FUNCTION_PARAM_PASSTHRU, PDO_MIMER_SAVEPOINT_SET);
+}
+
+
+/**
+ * @brief The PHP method <code>mimerRollbackTo()</code> extends the <code>PDO</code> class to undo the work done since
+ * a savepoint was set, without ending the transaction.
+ * @param return_value [out] true upon success, false upon failure.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerRollbackTo) {
+    pdo_mimer_savepoint_method(INTERNAL_FUNCTION_PARAM_PASSTHRU, PDO_MIMER_SAVEPOINT_ROLLBACK);
+}
+
+
+/**
+ * @brief The PHP method <code>mimerRelease()</code> extends the <code>PDO</code> class to discard a savepoint, and
+ * the ones set after it, keeping the work done since.
+ * @param return_value [out] true upon success, false upon failure.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerRelease) {
+    pdo_mimer_savepoint_method(INTERNAL_FUNCTION_PARAM_PASSTHRU, PDO_MIMER_SAVEPOINT_RELEASE);
+}
+
+
+/**
+ * @brief The PHP method <code>mimerExecScript()</code> extends the <code>PDO</code> class to execute an SQL script,
+ * i.e. statements separated by semicolons, in one call.
+ * @param return_value [out] An array with the <code>sql</code>, <code>time_ms</code> and <code>error</code> (NULL or
+ * an errorInfo array) of each statement executed, false if the script failed.
+ * @remark The script is split by @ref pdo_mimer_script_next. With the option <code>transaction</code> the statements
+ * run in one transaction, which is committed at the end or rolled back on failure. With the option
+ * <code>continue_on_error</code> a failing statement is recorded in the result and execution goes on, otherwise the
+ * script stops at the first error, which is reported according to the error mode.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerExecScript) {
+    pdo_dbh_t *dbh = Z_PDO_DBH_P(ZEND_THIS);
+    pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+    zend_string *script;
+    HashTable *options = NULL;
+    bool use_transaction, continue_on_error, failed = false;
+    const char *cursor, *end, *start, *stmt_end;
+    char *buffer;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_STR(script)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_ARRAY_HT(options)
+    ZEND_PARSE_PARAMETERS_END();
+
+    use_transaction = pdo_mimer_option_bool(options, "transaction", false);
+    continue_on_error = pdo_mimer_option_bool(options, "continue_on_error", false);
+
+    strcpy(dbh->error_code, PDO_ERR_NONE);
+    pdo_mimer_claim_sessions(mimer_dbh);
+    if (use_transaction) {
+        if (mimer_dbh->transaction.is_in_transaction) {
+            zend_throw_exception_ex(php_pdo_get_exception(), 0, "There is already an active transaction");
+            RETURN_THROWS();
+        }
+        if (!mimer_handle_transaction(dbh, true, MIMER_TRANS_DEFAULT)) {
+            pdo_handle_error(dbh, NULL);
+            RETURN_FALSE;
+        }
+    }
+
+    /* the statements are null-terminated in place, in a copy of the script */
+    buffer = estrndup(ZSTR_VAL(script), ZSTR_LEN(script));
+    cursor = buffer;
+    end = buffer + ZSTR_LEN(script);
+    array_init(return_value);
+
+    while ((start = pdo_mimer_script_next(&cursor, end, &stmt_end)) != NULL) {
+        uint64_t started = pdo_mimer_hrtime();
+        zval entry;
+        bool success;
+
+        buffer[stmt_end - buffer] = '\0';
+        success = pdo_mimer_ensure_transaction(dbh);
+        if (success && !(success = MIMER_SUCCEEDED(MimerExecuteStatement8(mimer_dbh->session, start))))
+            pdo_mimer_dbh_error();
+        PDO_MIMER_STATS_INC(executes);
+        PDO_MIMER_STATS_ADD(execute_ns, pdo_mimer_hrtime() - started);
+
+        array_init(&entry);
+        add_assoc_stringl(&entry, "sql", start, stmt_end - start);
+        add_assoc_double(&entry, "time_ms", (pdo_mimer_hrtime() - started) / 1e6);
+        if (success) {
+            add_assoc_null(&entry, "error");
+        } else {
+            zval error_info;
+            array_init(&error_info);
+            add_next_index_string(&error_info, dbh->error_code);
+            pdo_mimer_fetch_err(dbh, NULL, &error_info);
+            add_assoc_zval(&entry, "error", &error_info);
+        }
+        add_next_index_zval(return_value, &entry);
+
+        if (!success && !continue_on_error) {
+            failed = true;
+            break;
+        }
+    }
+    efree(buffer);
+
+    if (use_transaction) {
+        if (failed)
+            pdo_mimer_abandon_transaction(dbh);
+        else if (mimer_dbh->transaction.is_in_transaction && !mimer_handle_transaction(dbh, false, MIMER_COMMIT)) {
+            pdo_mimer_abandon_transaction(dbh);
+            failed = true;
+        }
+    }
+
+    if (failed) {
+        zval_ptr_dtor(return_value);
+        pdo_handle_error(dbh, NULL);
+        RETURN_FALSE;
+    }
 }
 
 
@@ -548,6 +1592,15 @@ static bool pdo_mimer_in_transaction(pdo_dbh_t *dbh) {
 }
 
 
+/**
+ * @brief PDO method called at the end of each request using a persistent connection.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ */
+static void pdo_mimer_persistent_shutdown(pdo_dbh_t *dbh) {
+	pdo_mimer_free_column_names(dbh->driver_data);
+}
+
+
 /* declares the methods Mimer uses and give them to the PDO driver */
 static const struct pdo_dbh_methods mimer_methods = { /* {{{ */
         mimer_handle_closer,   /* handle closer method */
@@ -563,21 +1616,89 @@ static const struct pdo_dbh_methods mimer_methods = { /* {{{ */
         pdo_mimer_get_attribute,   /* handle get attribute method */
         pdo_mimer_check_liveness,   /* check liveness method */
         pdo_mimer_get_driver_methods,   /* get driver method */
-        NULL,   /* persistent connection shutdown method */
+        pdo_mimer_persistent_shutdown,   /* persistent connection shutdown method */
         pdo_mimer_in_transaction,    /* in transaction method */
         NULL    /* get gc method */
 };
 
 
+static void pdo_mimer_warmup_dtor(zval *entry) {
+	MimerStatement statement = Z_PTR_P(entry);
+
+	if (statement != MIMERNULLHANDLE)
+		MimerEndStatement(&statement);
+}
+
+
+/**
+ * @brief Prepares the statements listed in a warm-up file, so that the first prepare of each does not pay the
+ * compile latency.
+ * @param dbh [in] A pointer to the PDO database handle object.
+ * @param path [in] Path to a file with one SQL statement per line.
+ * @remark Blank lines and lines starting with <code>--</code> are skipped and a trailing semicolon is ignored.
+ * Statements that fail to prepare are only counted, warm-up never fails the connection.
+ */
+static void pdo_mimer_warmup(pdo_dbh_t *dbh, const char *path) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+	uint64_t start = pdo_mimer_hrtime();
+	zend_string *contents;
+	php_stream *stream;
+
+	if ((stream = php_stream_open_wrapper((char *) path, "rb", REPORT_ERRORS, NULL)) == NULL)
+		return;
+
+	contents = php_stream_copy_to_mem(stream, PHP_STREAM_COPY_ALL, false);
+	php_stream_close(stream);
+	if (contents == NULL)
+		return;
+
+	mimer_dbh->warmup.statements = pemalloc(sizeof(HashTable), dbh->is_persistent);
+	zend_hash_init(mimer_dbh->warmup.statements, 16, NULL, pdo_mimer_warmup_dtor, dbh->is_persistent);
+
+	char *line = ZSTR_VAL(contents), *end = line + ZSTR_LEN(contents);
+	while (line < end) {
+		char *line_end = memchr(line, '\n', end - line);
+		char *next = line_end ? line_end + 1 : end;
+		char *last = line_end ? line_end : end;
+
+		while (line < last && isspace((unsigned char) *line))
+			line++;
+		while (last > line && (isspace((unsigned char) last[-1]) || last[-1] == ';'))
+			last--;
+
+		if (last > line && strncmp(line, "--", 2) != 0) {
+			MimerStatement statement = MIMERNULLHANDLE;
+			*last = '\0'; /* the buffer is ours, terminate the statement in place */
+
+			if (!MIMER_SUCCEEDED(MimerBeginStatement8(mimer_dbh->session, line, MIMER_FORWARD_ONLY, &statement))) {
+				mimer_dbh->warmup.failed++;
+			} else if (zend_hash_str_add_ptr(mimer_dbh->warmup.statements, line, last - line, statement) == NULL) {
+				MimerEndStatement(&statement); /* listed twice */
+			} else {
+				mimer_dbh->warmup.prepared++;
+			}
+		}
+
+		line = next;
+	}
+
+	zend_string_release(contents);
+	mimer_dbh->warmup.time_ns = pdo_mimer_hrtime() - start;
+}
+
+
 static bool pdo_mimer_create_session(pdo_dbh_t *dbh) {
 	pdo_mimer_dbh *mimer_dbh = dbh->driver_data = pecalloc(1, sizeof(pdo_mimer_dbh), dbh->is_persistent);
 	mimer_dbh->session = MIMERNULLHANDLE;
+	mimer_dbh->read_session = MIMERNULLHANDLE;
 
-	enum opts_enum { db_name, username, password, num_opts };
+	enum opts_enum { db_name, username, password, warmup, read_db_name, num_opts };
 	struct pdo_data_src_parser opts[] = {
 		{ "dbname", NULL, 0 },
 		{ "user",   "",   0 },
 		{ "password",   NULL, 0 },
+		{ "warmup", NULL, 0 },
+		{ "read_dbname", NULL, 0 },
 	};
 
 	php_pdo_parse_data_source(dbh->data_source, dbh->data_source_len, opts, num_opts);
@@ -588,7 +1709,26 @@ static bool pdo_mimer_create_session(pdo_dbh_t *dbh) {
 	if (!dbh->password && opts[password].optval)
 		dbh->password = pestrdup(opts[password].optval, dbh->is_persistent);
 
+	if (opts[db_name].optval != NULL)
+		mimer_dbh->async.db_name = pestrdup(opts[db_name].optval, dbh->is_persistent);
+
 	bool success = MIMER_SUCCEEDED(MimerBeginSession8(opts[db_name].optval, dbh->username, dbh->password, &mimer_dbh->session));
+	PDO_MIMER_STATS_ADD(sessions_opened, success);
+
+	if (success && opts[read_db_name].optval != NULL && !MIMER_SUCCEEDED(MimerBeginSession8(opts[read_db_name].optval,
+		dbh->username, dbh->password, &mimer_dbh->read_session))) {
+		/* report the read session's error, the handle closer ends whichever session is left */
+		MimerEndSession(&mimer_dbh->session);
+		mimer_dbh->session = mimer_dbh->read_session;
+		mimer_dbh->read_session = MIMERNULLHANDLE;
+		success = false;
+	}
+	PDO_MIMER_STATS_ADD(sessions_opened, mimer_dbh->read_session != MIMERNULLHANDLE);
+
+	/* the DSN option takes precedence over pdo_mimer.warmup_file */
+	const char *warmup_file = opts[warmup].optval ? opts[warmup].optval : PDO_MIMER_G(warmup_file);
+	if (success && warmup_file != NULL && *warmup_file != '\0')
+		pdo_mimer_warmup(dbh, warmup_file);
 
 	for (int i = 0; i < num_opts; i++) {
 		if (opts[i].freeme)
@@ -615,6 +1755,7 @@ static int pdo_mimer_handle_factory(pdo_dbh_t *dbh, zval *driver_options) {
     /* provide the PDO handler with information about our driver */
 	dbh->alloc_own_columns = true;
 	dbh->max_escaped_char_length = 2;
+	dbh->auto_commit = pdo_attr_lval(driver_options, PDO_ATTR_AUTOCOMMIT, 1);
     dbh->methods = &mimer_methods; /* an array of methods that PDO can call provided by our driver */
     dbh->skip_param_evt = 1 << PDO_PARAM_EVT_NORMALIZE
             | 1 << PDO_PARAM_EVT_FREE
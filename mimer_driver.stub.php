@@ -0,0 +1,40 @@
+<?php
+
+/** @generate-function-entries */
+
+// These are extension methods for PDO. This is not a real class.
+class PDO_MimerSQL_Ext {
+
+    /** @tentative-return-type */
+    public function mimerIsTransient(PDOException $exception): bool {}
+
+    /** @tentative-return-type */
+    public function mimerTransaction(callable $work, array $options = []): mixed {}
+
+    /** @tentative-return-type */
+    public function mimerSavepoint(string $name): bool {}
+
+    /** @tentative-return-type */
+    public function mimerRollbackTo(string $name): bool {}
+
+    /** @tentative-return-type */
+    public function mimerRelease(string $name): bool {}
+
+    /** @tentative-return-type */
+    public function mimerExecScript(string $sql, array $options = []): array|false {}
+
+    /** @tentative-return-type */
+    public function mimerQueryAsync(string $sql, array $params = [], array $options = []): MimerAsyncResult {}
+
+    /** @tentative-return-type */
+    public function mimerParallelInsert(string $sql, iterable $rows, int $sessions = 4, array $options = []): array|false {}
+
+    /** @tentative-return-type */
+    public function mimerParallelScan(string $sql, array $ranges, int $threads = 4, array $options = []): MimerScanResult {}
+
+    /** @tentative-return-type */
+    public function mimerGetStats(bool $reset = false): array {}
+
+    /** @tentative-return-type */
+    public function mimerExportStats(): string {}
+}
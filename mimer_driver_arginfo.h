@@ -0,0 +1,80 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: 7a0d970c1b0780d63c07d595888f03313e5e23b4 */
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerIsTransient, 0, 1, _IS_BOOL, 0)
+	ZEND_ARG_OBJ_INFO(0, exception, PDOException, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerTransaction, 0, 1, IS_MIXED, 0)
+	ZEND_ARG_TYPE_INFO(0, work, IS_CALLABLE, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerSavepoint, 0, 1, _IS_BOOL, 0)
+	ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_class_PDO_MimerSQL_Ext_mimerRollbackTo arginfo_class_PDO_MimerSQL_Ext_mimerSavepoint
+
+#define arginfo_class_PDO_MimerSQL_Ext_mimerRelease arginfo_class_PDO_MimerSQL_Ext_mimerSavepoint
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_MASK_EX(arginfo_class_PDO_MimerSQL_Ext_mimerExecScript, 0, 1, MAY_BE_ARRAY|MAY_BE_FALSE)
+	ZEND_ARG_TYPE_INFO(0, sql, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_OBJ_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerQueryAsync, 0, 1, MimerAsyncResult, 0)
+	ZEND_ARG_TYPE_INFO(0, sql, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, params, IS_ARRAY, 0, "[]")
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_MASK_EX(arginfo_class_PDO_MimerSQL_Ext_mimerParallelInsert, 0, 2, MAY_BE_ARRAY|MAY_BE_FALSE)
+	ZEND_ARG_TYPE_INFO(0, sql, IS_STRING, 0)
+	ZEND_ARG_OBJ_TYPE_MASK(0, rows, Traversable, MAY_BE_ARRAY, NULL)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, sessions, IS_LONG, 0, "4")
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_OBJ_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerParallelScan, 0, 2, MimerScanResult, 0)
+	ZEND_ARG_TYPE_INFO(0, sql, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO(0, ranges, IS_ARRAY, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, threads, IS_LONG, 0, "4")
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, options, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerGetStats, 0, 0, IS_ARRAY, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, reset, _IS_BOOL, 0, "false")
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_INFO_EX(arginfo_class_PDO_MimerSQL_Ext_mimerExportStats, 0, 0, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerIsTransient);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerTransaction);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerSavepoint);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerRollbackTo);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerRelease);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerExecScript);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerQueryAsync);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerParallelInsert);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerParallelScan);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerGetStats);
+ZEND_METHOD(PDO_MimerSQL_Ext, mimerExportStats);
+
+
+static const zend_function_entry class_PDO_MimerSQL_Ext_methods[] = {
+	ZEND_ME(PDO_MimerSQL_Ext, mimerIsTransient, arginfo_class_PDO_MimerSQL_Ext_mimerIsTransient, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerTransaction, arginfo_class_PDO_MimerSQL_Ext_mimerTransaction, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerSavepoint, arginfo_class_PDO_MimerSQL_Ext_mimerSavepoint, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerRollbackTo, arginfo_class_PDO_MimerSQL_Ext_mimerRollbackTo, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerRelease, arginfo_class_PDO_MimerSQL_Ext_mimerRelease, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerExecScript, arginfo_class_PDO_MimerSQL_Ext_mimerExecScript, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerQueryAsync, arginfo_class_PDO_MimerSQL_Ext_mimerQueryAsync, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerParallelInsert, arginfo_class_PDO_MimerSQL_Ext_mimerParallelInsert, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerParallelScan, arginfo_class_PDO_MimerSQL_Ext_mimerParallelScan, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerGetStats, arginfo_class_PDO_MimerSQL_Ext_mimerGetStats, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDO_MimerSQL_Ext, mimerExportStats, arginfo_class_PDO_MimerSQL_Ext_mimerExportStats, ZEND_ACC_PUBLIC)
+	ZEND_FE_END
+};
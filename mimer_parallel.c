@@ -0,0 +1,1067 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "zend_exceptions.h"
+#include "ext/spl/spl_iterators.h"
+#include "pdo/php_pdo.h"
+#include "pdo/php_pdo_driver.h"
+#include "php_pdo_mimer.h"
+#include "php_pdo_mimer_int.h"
+#include "pdo_mimer_thread.h"
+#include "mimer_parallel_arginfo.h"
+
+/* rows of a partition there is room for at first, the room doubles as needed */
+#define PDO_MIMER_INSERT_MIN_ROWS 64
+
+typedef struct pdo_mimer_parallel_insert_t pdo_mimer_parallel_insert;
+
+/**
+ * @brief The rows one worker thread of <code>mimerParallelInsert()</code> inserts, on a session of its own.
+ */
+typedef struct pdo_mimer_insert_partition_t {
+	pdo_mimer_parallel_insert *insert;
+	pdo_mimer_thread thread;
+	bool is_running;                 /* the thread has been started and not joined */
+	pdo_mimer_worker_session session;
+
+	pdo_mimer_worker_param *values;  /* num_rows rows of num_params values */
+	size_t rows_size;                /* number of rows there is room for */
+	size_t num_rows;
+
+	/* output, read once the thread is joined */
+	size_t rows_inserted;            /* rows sent to the server, kept only if committed */
+	uint64_t time_ns;
+	bool is_committed;
+	pdo_mimer_worker_error error;
+} pdo_mimer_insert_partition;
+
+/**
+ * @brief A parallel insert, its rows partitioned across worker threads.
+ * @remark With the commit policy "all" the workers wait for each other before ending their transactions, and all
+ * commit only if all succeeded. This is not atomic: each partition is still committed in its own transaction, one after
+ * the other. With the policy "partition" each worker commits its partition on its own.
+ */
+struct pdo_mimer_parallel_insert_t {
+	pdo_mimer_mutex lock;
+	pdo_mimer_cond cond;
+	char *sql;
+	int num_params;                  /* values per row, set by the first row */
+	zend_long batch_size;            /* rows sent per MimerExecute() */
+	bool is_all;                     /* commit policy "all", which waits for every partition but is not atomic */
+	int num_partitions;
+	int num_finished;                /* partitions done inserting, under the lock */
+	bool has_failed;                 /* a partition failed, under the lock */
+	pdo_mimer_insert_partition *partitions;
+};
+
+/* why a row could not be added to a partition */
+typedef enum {
+	PDO_MIMER_ROW_OK,
+	PDO_MIMER_ROW_NOT_ARRAY,
+	PDO_MIMER_ROW_WRONG_COUNT,
+	PDO_MIMER_ROW_NOT_SCALAR,
+	PDO_MIMER_ROW_NO_KEY,
+	PDO_MIMER_ROW_OUT_OF_MEMORY,
+} pdo_mimer_row_status;
+
+typedef struct {
+	pdo_mimer_parallel_insert *insert;
+	zval *key;                       /* the key of the column rows are partitioned by, NULL for round-robin */
+	zend_ulong num_rows;
+	pdo_mimer_row_status status;
+} pdo_mimer_insert_rows_ctx;
+
+
+/**
+ * @brief Tells the other workers this one is done inserting and, with the commit policy "all", waits for them.
+ * @param success [in] Whether this worker inserted all its rows.
+ * @param wait [in] Whether to wait, false when called on the PHP thread for a worker which could not be started.
+ * @return true if the worker is to commit
+ */
+static bool pdo_mimer_insert_finish(pdo_mimer_parallel_insert *insert, bool success, bool wait) {
+	pdo_mimer_mutex_lock(&insert->lock);
+
+	insert->has_failed |= !success;
+	insert->num_finished++;
+	pdo_mimer_cond_broadcast(&insert->cond);
+
+	while (wait && insert->is_all && insert->num_finished < insert->num_partitions)
+		pdo_mimer_cond_wait(&insert->cond, &insert->lock);
+
+	bool commit = success && !(insert->is_all && insert->has_failed);
+	pdo_mimer_mutex_unlock(&insert->lock);
+
+	return commit;
+}
+
+
+static bool pdo_mimer_insert_has_failed(pdo_mimer_parallel_insert *insert) {
+	pdo_mimer_mutex_lock(&insert->lock);
+	bool has_failed = insert->has_failed;
+	pdo_mimer_mutex_unlock(&insert->lock);
+
+	return has_failed;
+}
+
+
+/**
+ * @brief Inserts the rows of a partition in batches, through the same MimerAddBatch() path as
+ * <code>PDOStatement::mimerAddBatch()</code>.
+ * @return true if all rows were sent
+ * @remark Worker thread. With the commit policy "all" the worker stops between batches once another one failed.
+ */
+static bool pdo_mimer_insert_rows(pdo_mimer_insert_partition *partition, MimerStatement statement) {
+	pdo_mimer_parallel_insert *insert = partition->insert;
+	MimerReturnCode return_code = MIMER_SUCCESS;
+
+	for (size_t row = 0; row < partition->num_rows; row++) {
+		const pdo_mimer_worker_param *values = &partition->values[row * insert->num_params];
+
+		for (int16_t paramno = 1; paramno <= insert->num_params && MIMER_SUCCEEDED(return_code); paramno++)
+			return_code = pdo_mimer_worker_param_set(&values[paramno - 1], statement, paramno);
+
+		/* the last row of a batch is sent along with the batch by MimerExecute() */
+		if (!MIMER_SUCCEEDED(return_code)) {
+			break;
+		} else if ((row + 1) % insert->batch_size != 0 && row + 1 < partition->num_rows) {
+			return_code = MimerAddBatch(statement);
+		} else if (MIMER_SUCCEEDED(return_code = MimerExecute(statement))) {
+			partition->rows_inserted = row + 1;
+			if (insert->is_all && pdo_mimer_insert_has_failed(insert))
+				return false;
+		}
+
+		if (!MIMER_SUCCEEDED(return_code))
+			break;
+	}
+
+	if (MIMER_SUCCEEDED(return_code))
+		return true;
+
+	pdo_mimer_worker_api_error(&partition->error, (MimerHandle) statement);
+	return false;
+}
+
+
+PDO_MIMER_THREAD_FUNC(pdo_mimer_insert_main, arg) {
+	pdo_mimer_insert_partition *partition = arg;
+	pdo_mimer_parallel_insert *insert = partition->insert;
+	uint64_t started = pdo_mimer_hrtime();
+	MimerStatement statement = MIMERNULLHANDLE;
+	MimerSession session = MIMERNULLHANDLE;
+	bool success = false;
+
+	if (pdo_mimer_worker_session_begin(&partition->session, &partition->error)) {
+		session = partition->session.session;
+
+		if (!MIMER_SUCCEEDED(MimerBeginTransaction(session, MIMER_TRANS_READWRITE))) {
+			pdo_mimer_worker_api_error(&partition->error, (MimerHandle) session);
+			session = MIMERNULLHANDLE;
+		} else if (!MIMER_SUCCEEDED(MimerBeginStatement8(session, insert->sql, MIMER_FORWARD_ONLY, &statement))) {
+			pdo_mimer_worker_api_error(&partition->error, (MimerHandle) session);
+		} else {
+			success = pdo_mimer_insert_rows(partition, statement);
+			MimerEndStatement(&statement);
+		}
+	}
+
+	bool commit = pdo_mimer_insert_finish(insert, success, true);
+
+	if (session != MIMERNULLHANDLE) {
+		if (commit && MIMER_SUCCEEDED(MimerEndTransaction(session, MIMER_COMMIT)))
+			partition->is_committed = true;
+		else if (commit)
+			pdo_mimer_worker_api_error(&partition->error, (MimerHandle) session);
+		else
+			MimerEndTransaction(session, MIMER_ROLLBACK);
+	}
+
+	partition->time_ns = pdo_mimer_hrtime() - started;
+	PDO_MIMER_THREAD_RETURN;
+}
+
+
+/**
+ * @brief Converts a row on the PHP thread and adds it to its partition.
+ * @remark The partition is picked round-robin, or by the hash of the row's value at the key if one is given, so that
+ * rows with the same key go to the same session.
+ */
+static pdo_mimer_row_status pdo_mimer_insert_add_row(pdo_mimer_insert_rows_ctx *ctx, zval *row) {
+	pdo_mimer_parallel_insert *insert = ctx->insert;
+	pdo_mimer_insert_partition *partition;
+	zval *value;
+	int colno = 0;
+
+	ZVAL_DEREF(row);
+	if (Z_TYPE_P(row) != IS_ARRAY)
+		return PDO_MIMER_ROW_NOT_ARRAY;
+
+	if (insert->num_params == 0)
+		insert->num_params = (int) MIN(zend_hash_num_elements(Z_ARRVAL_P(row)), INT16_MAX);
+	if (insert->num_params == 0 || zend_hash_num_elements(Z_ARRVAL_P(row)) != (uint32_t) insert->num_params)
+		return PDO_MIMER_ROW_WRONG_COUNT;
+
+	if (ctx->key == NULL) {
+		partition = &insert->partitions[ctx->num_rows % insert->num_partitions];
+	} else {
+		zval *key_value = Z_TYPE_P(ctx->key) == IS_LONG ? zend_hash_index_find(Z_ARRVAL_P(row), Z_LVAL_P(ctx->key)) :
+			zend_symtable_find(Z_ARRVAL_P(row), Z_STR_P(ctx->key));
+		if (key_value == NULL)
+			return PDO_MIMER_ROW_NO_KEY;
+
+		zend_string *tmp_str, *str = zval_get_tmp_string(key_value, &tmp_str);
+		partition = &insert->partitions[zend_string_hash_val(str) % insert->num_partitions];
+		zend_tmp_string_release(tmp_str);
+	}
+
+	if (partition->num_rows == partition->rows_size) {
+		size_t rows_size = MAX(partition->rows_size * 2, PDO_MIMER_INSERT_MIN_ROWS);
+		pdo_mimer_worker_param *values = realloc(partition->values,
+			rows_size * insert->num_params * sizeof(pdo_mimer_worker_param));
+		if (values == NULL)
+			return PDO_MIMER_ROW_OUT_OF_MEMORY;
+
+		partition->values = values;
+		partition->rows_size = rows_size;
+	}
+
+	pdo_mimer_worker_param *values = &partition->values[partition->num_rows * insert->num_params];
+	memset(values, 0, insert->num_params * sizeof(pdo_mimer_worker_param));
+
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(row), value) {
+		pdo_mimer_row_status status = PDO_MIMER_ROW_OK;
+
+		ZVAL_DEREF(value);
+		if (Z_TYPE_P(value) > IS_STRING)
+			status = PDO_MIMER_ROW_NOT_SCALAR;
+		else if (!pdo_mimer_worker_param_init(&values[colno], value))
+			status = PDO_MIMER_ROW_OUT_OF_MEMORY;
+
+		if (status != PDO_MIMER_ROW_OK) {
+			while (colno >= 0)
+				pdo_mimer_worker_param_free(&values[colno--]);
+			return status;
+		}
+		colno++;
+	} ZEND_HASH_FOREACH_END();
+
+	partition->num_rows++;
+	ctx->num_rows++;
+	return PDO_MIMER_ROW_OK;
+}
+
+
+static int pdo_mimer_insert_add_iterator_row(zend_object_iterator *iter, void *arg) {
+	pdo_mimer_insert_rows_ctx *ctx = arg;
+	zval *row = iter->funcs->get_current_data(iter);
+
+	if (row == NULL || EG(exception))
+		return ZEND_HASH_APPLY_STOP;
+
+	ctx->status = pdo_mimer_insert_add_row(ctx, row);
+	return ctx->status == PDO_MIMER_ROW_OK ? ZEND_HASH_APPLY_KEEP : ZEND_HASH_APPLY_STOP;
+}
+
+
+static void pdo_mimer_insert_free(pdo_mimer_parallel_insert *insert) {
+	for (int i = 0; i < insert->num_partitions; i++) {
+		pdo_mimer_insert_partition *partition = &insert->partitions[i];
+
+		for (size_t j = 0; j < partition->num_rows * insert->num_params; j++)
+			pdo_mimer_worker_param_free(&partition->values[j]);
+		free(partition->values);
+		pdo_mimer_worker_error_free(&partition->error);
+	}
+
+	pdo_mimer_cond_destroy(&insert->cond);
+	pdo_mimer_mutex_destroy(&insert->lock);
+	efree(insert->partitions);
+	free(insert->sql);
+}
+
+
+/**
+ * @brief Adds the number of rows, time and throughput of an insert, or of one of its partitions, to an array.
+ */
+static void pdo_mimer_insert_add_totals(zval *array, size_t rows, uint64_t time_ns, bool is_committed) {
+	add_assoc_long(array, "rows", (zend_long) rows);
+	add_assoc_double(array, "time_ms", time_ns / 1e6);
+	add_assoc_double(array, "rows_per_sec", time_ns > 0 ? rows * 1e9 / time_ns : 0.0);
+	add_assoc_bool(array, "committed", is_committed);
+}
+
+
+/**
+ * @brief The PHP method <code>mimerParallelInsert()</code> extends the <code>PDO</code> class to insert rows through
+ * several sessions at once, each in a worker thread of its own.
+ * @param sql [in] The INSERT statement, with one positional placeholder per value of a row.
+ * @param rows [in] An array or Traversable of rows, each an array of scalar or null values.
+ * @param sessions [in] The number of worker threads and sessions, between 1 and PDO_MIMER_PARALLEL_MAX_SESSIONS.
+ * @param options [in] <code>key</code>: partition the rows by the hash of the value at this key rather than
+ * round-robin, <code>batch_size</code>: rows sent per round trip, <code>commit</code>: "all" to commit the partitions
+ * only if all succeeded, or "partition" to commit each partition that succeeded.
+ * @param return_value [out] The rows, time_ms, rows_per_sec and whether they were committed, in total and for each
+ * partition along with its error (NULL or an errorInfo array); false if the policy is "all" and a partition failed.
+ * @remark The rows are converted on the PHP thread before the workers start. The workers take sessions from the
+ * connection's pool, or begin new ones with the connection's credentials, and run outside of its transaction. With
+ * the policy "all" a failure is reported according to the error mode; with "partition" it is recorded in the result.
+ * The policy "all" is not atomic: the partitions are committed one by one, and a commit failing under it cannot undo
+ * the partitions already committed.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerParallelInsert) {
+	pdo_dbh_t *dbh = Z_PDO_DBH_P(ZEND_THIS);
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+	pdo_mimer_parallel_insert insert = { 0 };
+	pdo_mimer_insert_rows_ctx ctx = { .insert = &insert, .status = PDO_MIMER_ROW_OK };
+	zend_string *sql;
+	zval *rows, *row, *commit;
+	zend_long sessions = 4;
+	HashTable *options = NULL;
+
+	ZEND_PARSE_PARAMETERS_START(2, 4)
+		Z_PARAM_STR(sql)
+		Z_PARAM_ITERABLE(rows)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(sessions)
+		Z_PARAM_ARRAY_HT(options)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (sessions < 1 || sessions > PDO_MIMER_PARALLEL_MAX_SESSIONS) {
+		zend_argument_value_error(3, "must be between 1 and %d", PDO_MIMER_PARALLEL_MAX_SESSIONS);
+		RETURN_THROWS();
+	}
+
+	insert.batch_size = pdo_mimer_option_long(options, "batch_size", PDO_MIMER_PARALLEL_BATCH_SIZE);
+	if (insert.batch_size < 1) {
+		zend_argument_value_error(4, "option \"batch_size\" must be greater than 0");
+		RETURN_THROWS();
+	}
+
+	insert.is_all = true;
+	if (options != NULL && (commit = zend_hash_str_find(options, "commit", sizeof("commit") - 1)) != NULL) {
+		if (Z_TYPE_P(commit) != IS_STRING || (!zend_string_equals_literal(Z_STR_P(commit), "all") &&
+			!zend_string_equals_literal(Z_STR_P(commit), "partition"))) {
+			zend_argument_value_error(4, "option \"commit\" must be either \"all\" or \"partition\"");
+			RETURN_THROWS();
+		}
+		insert.is_all = zend_string_equals_literal(Z_STR_P(commit), "all");
+	}
+
+	if (options != NULL && (ctx.key = zend_hash_str_find_deref(options, "key", sizeof("key") - 1)) != NULL) {
+		if (Z_TYPE_P(ctx.key) == IS_NULL) {
+			ctx.key = NULL;
+		} else if (Z_TYPE_P(ctx.key) != IS_LONG && Z_TYPE_P(ctx.key) != IS_STRING) {
+			zend_argument_type_error(4, "option \"key\" must be of type int|string|null");
+			RETURN_THROWS();
+		}
+	}
+
+	if ((insert.sql = pdo_mimer_worker_strdup(ZSTR_VAL(sql), ZSTR_LEN(sql))) == NULL) {
+		zend_throw_error(NULL, "Out of memory");
+		RETURN_THROWS();
+	}
+
+	pdo_mimer_mutex_init(&insert.lock);
+	pdo_mimer_cond_init(&insert.cond);
+	insert.num_partitions = (int) sessions;
+	insert.partitions = ecalloc(insert.num_partitions, sizeof(pdo_mimer_insert_partition));
+
+	if (Z_TYPE_P(rows) == IS_ARRAY) {
+		ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(rows), row) {
+			if ((ctx.status = pdo_mimer_insert_add_row(&ctx, row)) != PDO_MIMER_ROW_OK)
+				break;
+		} ZEND_HASH_FOREACH_END();
+	} else {
+		spl_iterator_apply(rows, pdo_mimer_insert_add_iterator_row, &ctx);
+	}
+
+	if (EG(exception) || ctx.status != PDO_MIMER_ROW_OK) {
+		pdo_mimer_insert_free(&insert);
+
+		switch (ctx.status) {
+			case PDO_MIMER_ROW_NOT_ARRAY:
+				zend_argument_type_error(2, "must contain only arrays");
+				break;
+			case PDO_MIMER_ROW_WRONG_COUNT:
+				zend_argument_value_error(2, "must contain non-empty arrays of the same number of values");
+				break;
+			case PDO_MIMER_ROW_NOT_SCALAR:
+				zend_argument_type_error(2, "must contain only scalar or null values");
+				break;
+			case PDO_MIMER_ROW_NO_KEY:
+				zend_argument_value_error(2, "must contain the key given by option \"key\" in every row");
+				break;
+			case PDO_MIMER_ROW_OUT_OF_MEMORY:
+				zend_throw_error(NULL, "Out of memory");
+				break;
+			default:
+				break;
+		}
+		RETURN_THROWS();
+	}
+
+	uint64_t started = pdo_mimer_hrtime();
+
+	/* empty partitions have nothing to insert, nor to wait for */
+	for (int i = 0; i < insert.num_partitions; i++) {
+		pdo_mimer_insert_partition *partition = &insert.partitions[i];
+
+		partition->insert = &insert;
+		partition->session.session = MIMERNULLHANDLE;
+		if (partition->num_rows == 0) {
+			partition->is_committed = true;
+			insert.num_finished++;
+		}
+	}
+
+	for (int i = 0; i < insert.num_partitions; i++) {
+		pdo_mimer_insert_partition *partition = &insert.partitions[i];
+
+		if (partition->num_rows == 0)
+			continue;
+
+		if (!pdo_mimer_worker_session_take(dbh, &partition->session)) {
+			pdo_mimer_worker_custom_error(&partition->error, SQLSTATE_MEMORY_ALLOCATION_ERROR,
+				PDO_MIMER_OUT_OF_MEMORY, "Out of memory");
+			pdo_mimer_insert_finish(&insert, false, false);
+		} else if (!(partition->is_running = pdo_mimer_thread_create(&partition->thread, pdo_mimer_insert_main,
+			partition))) {
+			pdo_mimer_worker_custom_error(&partition->error, SQLSTATE_MEMORY_ALLOCATION_ERROR,
+				PDO_MIMER_OUT_OF_MEMORY, "Could not start a worker thread");
+			pdo_mimer_insert_finish(&insert, false, false);
+		}
+	}
+
+	size_t total_rows = 0;
+	bool all_committed = true;
+	pdo_mimer_worker_error *first_error = NULL;
+	zval partitions;
+
+	array_init_size(&partitions, insert.num_partitions);
+
+	for (int i = 0; i < insert.num_partitions; i++) {
+		pdo_mimer_insert_partition *partition = &insert.partitions[i];
+		zval entry;
+
+		if (partition->is_running)
+			pdo_mimer_thread_join(partition->thread);
+		pdo_mimer_worker_session_release(mimer_dbh, &partition->session, &partition->error);
+
+		if (partition->is_committed)
+			total_rows += partition->rows_inserted;
+		all_committed &= partition->is_committed;
+		if (first_error == NULL && partition->error.code != MIMER_SUCCESS)
+			first_error = &partition->error;
+
+		array_init(&entry);
+		pdo_mimer_insert_add_totals(&entry, partition->rows_inserted, partition->time_ns, partition->is_committed);
+		pdo_mimer_worker_add_error(&entry, "error", &partition->error);
+		add_next_index_zval(&partitions, &entry);
+	}
+
+	strcpy(dbh->error_code, PDO_ERR_NONE);
+	if (first_error != NULL)
+		pdo_mimer_worker_set_error(dbh, first_error);
+
+	if (insert.is_all && first_error != NULL) {
+		zval_ptr_dtor(&partitions);
+		pdo_mimer_insert_free(&insert);
+		pdo_handle_error(dbh, NULL);
+		RETURN_FALSE;
+	}
+
+	array_init(return_value);
+	pdo_mimer_insert_add_totals(return_value, total_rows, pdo_mimer_hrtime() - started, all_committed);
+	add_assoc_zval(return_value, "partitions", &partitions);
+	pdo_mimer_insert_free(&insert);
+}
+
+
+typedef struct pdo_mimer_parallel_scan_t pdo_mimer_parallel_scan;
+
+/**
+ * @brief One range of a parallel scan: the values of the range predicate, and the rows fetched with them.
+ */
+typedef struct pdo_mimer_scan_range_t {
+	pdo_mimer_worker_param *params;
+	int num_params;
+	pdo_mimer_rows rows;
+	pdo_mimer_worker_error error;
+	bool is_done;                    /* under the lock */
+} pdo_mimer_scan_range;
+
+/**
+ * @brief A worker thread of a parallel scan, fetching one range after the other on its session.
+ */
+typedef struct pdo_mimer_scan_worker_t {
+	pdo_mimer_parallel_scan *scan;
+	pdo_mimer_thread thread;
+	bool is_running;                 /* the thread has been started and not joined */
+	pdo_mimer_worker_session session;
+	pdo_mimer_worker_error error;    /* why the session could not be begun, or was lost */
+} pdo_mimer_scan_worker;
+
+/**
+ * @brief A parallel scan, its ranges fetched by worker threads and read by the PHP thread as they complete.
+ * @remark Only plain malloc() memory is shared with the workers. Ranges are taken in order, and a failed range stops
+ * the workers from taking more: every range taken is completed, so the PHP thread never waits for one which is not.
+ * @remark The workers run at most max_pending ranges ahead of the reader, counting the ranges being fetched and those
+ * fetched but not read yet, and wait for the reader once they are that far ahead.
+ */
+struct pdo_mimer_parallel_scan_t {
+	pdo_mimer_mutex lock;
+	pdo_mimer_cond cond;
+	char *sql;
+	int num_ranges;
+	pdo_mimer_scan_range *ranges;
+	int num_workers;
+	pdo_mimer_scan_worker *workers;
+	int max_pending;                 /* ranges the workers may take beyond the ones read */
+
+	/* under the lock */
+	int next_range;                  /* the next range to take */
+	int num_read;                    /* ranges read, written by the PHP thread */
+	int *completed;                  /* the ranges in the order they were completed */
+	int num_completed;
+	bool is_cancelled;               /* no more ranges are to be taken */
+	char **column_names;             /* set by the first range with rows */
+	int num_columns;
+
+	/* PHP thread only */
+	bool is_ordered;                 /* rows are read in the order of the ranges, rather than as they complete */
+	pdo_mimer_scan_range *current;   /* the range rows are read from, NULL if none */
+	int current_row;
+	bool is_finished;                /* all rows were read, or a range failed */
+	zend_string **names;             /* interned column names, made at the first row fetched by name */
+	pdo_mimer_strings strings;
+};
+
+typedef struct pdo_mimer_scan_result_t {
+	pdo_mimer_parallel_scan *scan;
+	zend_object *dbh_object;         /* the PDO object, kept alive for the sessions to be given back to its pool */
+	zend_object std;
+} pdo_mimer_scan_result;
+
+static zend_class_entry *pdo_mimer_scan_result_ce;
+static zend_object_handlers pdo_mimer_scan_result_handlers;
+
+static inline pdo_mimer_scan_result *pdo_mimer_scan_result_from_obj(zend_object *obj) {
+	return (pdo_mimer_scan_result *) ((char *) obj - XtOffsetOf(pdo_mimer_scan_result, std));
+}
+
+#define Z_MIMER_SCAN_RESULT_P(zv) pdo_mimer_scan_result_from_obj(Z_OBJ_P(zv))
+
+/* how reading the next row of a scan went */
+typedef enum {
+	PDO_MIMER_SCAN_ROW,
+	PDO_MIMER_SCAN_END,
+	PDO_MIMER_SCAN_FAILED,
+} pdo_mimer_scan_status;
+
+
+/**
+ * @brief Takes the next range for a worker, waiting while the workers are max_pending ranges ahead of the reader.
+ * @return The index of the range, -1 if there is none left or the scan was cancelled.
+ */
+static int pdo_mimer_scan_take(pdo_mimer_parallel_scan *scan) {
+	pdo_mimer_mutex_lock(&scan->lock);
+	while (!scan->is_cancelled && scan->next_range < scan->num_ranges &&
+		scan->next_range - scan->num_read >= scan->max_pending)
+		pdo_mimer_cond_wait(&scan->cond, &scan->lock);
+	int index = scan->is_cancelled || scan->next_range == scan->num_ranges ? -1 : scan->next_range++;
+	pdo_mimer_mutex_unlock(&scan->lock);
+
+	return index;
+}
+
+
+static void pdo_mimer_scan_complete(pdo_mimer_parallel_scan *scan, int index) {
+	pdo_mimer_scan_range *range = &scan->ranges[index];
+
+	pdo_mimer_mutex_lock(&scan->lock);
+	range->is_done = true;
+	scan->completed[scan->num_completed++] = index;
+	scan->is_cancelled |= range->error.code != MIMER_SUCCESS;
+	pdo_mimer_cond_broadcast(&scan->cond);
+	pdo_mimer_mutex_unlock(&scan->lock);
+}
+
+
+/**
+ * @brief Fetches the rows of a range, decoding them like the prefetch thread does.
+ * @remark Worker thread.
+ */
+static void pdo_mimer_scan_range_run(pdo_mimer_parallel_scan *scan, pdo_mimer_scan_range *range, MimerSession session) {
+	MimerStatement statement = MIMERNULLHANDLE;
+	MimerReturnCode return_code = MIMER_SUCCESS;
+
+	if (!MIMER_SUCCEEDED(MimerBeginStatement8(session, scan->sql, MIMER_FORWARD_ONLY, &statement))) {
+		pdo_mimer_worker_api_error(&range->error, (MimerHandle) session);
+		return;
+	}
+
+	for (int16_t paramno = 1; paramno <= range->num_params && MIMER_SUCCEEDED(return_code); paramno++)
+		return_code = pdo_mimer_worker_param_set(&range->params[paramno - 1], statement, paramno);
+
+	if (MIMER_SUCCEEDED(return_code) && !MimerStatementHasResultSet(statement)) {
+		pdo_mimer_worker_custom_error(&range->error, SQLSTATE_PREPARED_STATEMENT_IS_NOT_A_CURSOR_SPECIFICATION,
+			PDO_MIMER_FEATURE_NOT_IMPLEMENTED, "The query of a parallel scan must return a result set");
+		MimerEndStatement(&statement);
+		return;
+	}
+
+	if (MIMER_SUCCEEDED(return_code))
+		return_code = pdo_mimer_rows_init(&range->rows, statement, MimerColumnCount(statement));
+
+	if (return_code == MIMER_SUCCESS && MIMER_SUCCEEDED(return_code = MimerOpenCursor(statement))) {
+		while (MIMER_SUCCEEDED(return_code = MimerFetch(statement)) && return_code != MIMER_NO_DATA) {
+			if ((return_code = pdo_mimer_rows_add(&range->rows, statement)) != MIMER_SUCCESS)
+				break;
+		}
+	}
+
+	/* every range has the same columns, their names are read once */
+	if (MIMER_SUCCEEDED(return_code)) {
+		pdo_mimer_mutex_lock(&scan->lock);
+		bool has_names = scan->column_names != NULL;
+		pdo_mimer_mutex_unlock(&scan->lock);
+
+		char **column_names = NULL;
+		if (!has_names && (return_code = pdo_mimer_worker_column_names(statement, range->rows.num_columns,
+			&column_names)) == MIMER_SUCCESS) {
+			pdo_mimer_mutex_lock(&scan->lock);
+			if (scan->column_names == NULL) {
+				scan->column_names = column_names;
+				scan->num_columns = range->rows.num_columns;
+				column_names = NULL;
+			}
+			pdo_mimer_mutex_unlock(&scan->lock);
+		}
+		pdo_mimer_worker_column_names_free(column_names, range->rows.num_columns);
+	}
+
+	if (return_code == PDO_MIMER_UNKNOWN_COLUMN_TYPE)
+		pdo_mimer_worker_custom_error(&range->error, SQLSTATE_FEATURE_NOT_SUPPORTED, PDO_MIMER_FEATURE_NOT_IMPLEMENTED,
+			"LOB columns cannot be fetched by a parallel scan");
+	else
+		pdo_mimer_worker_error_from(&range->error, return_code, (MimerHandle) statement);
+
+	MimerEndStatement(&statement);
+}
+
+
+PDO_MIMER_THREAD_FUNC(pdo_mimer_scan_main, arg) {
+	pdo_mimer_scan_worker *worker = arg;
+	pdo_mimer_parallel_scan *scan = worker->scan;
+	bool has_session = pdo_mimer_worker_session_begin(&worker->session, &worker->error);
+	int index;
+
+	while ((index = pdo_mimer_scan_take(scan)) >= 0) {
+		pdo_mimer_scan_range *range = &scan->ranges[index];
+
+		/* without a session the range fails with the session's error, which stops the scan */
+		if (has_session)
+			pdo_mimer_scan_range_run(scan, range, worker->session.session);
+		else
+			pdo_mimer_worker_custom_error(&range->error, worker->error.sqlstate, worker->error.code,
+				worker->error.msg != NULL ? worker->error.msg : "");
+
+		if (strncmp(range->error.sqlstate, "08", 2) == 0) {
+			worker->error.code = range->error.code;
+			strcpy(worker->error.sqlstate, range->error.sqlstate);
+		}
+
+		pdo_mimer_scan_complete(scan, index);
+	}
+
+	PDO_MIMER_THREAD_RETURN;
+}
+
+
+/**
+ * @brief Stops the workers, waiting for the ranges they are fetching, and gives their sessions back.
+ * @param mimer_dbh [in] The connection, NULL if it is gone.
+ */
+static void pdo_mimer_scan_stop(pdo_mimer_parallel_scan *scan, pdo_mimer_dbh *mimer_dbh) {
+	pdo_mimer_mutex_lock(&scan->lock);
+	scan->is_cancelled = true;
+	pdo_mimer_cond_broadcast(&scan->cond);
+	pdo_mimer_mutex_unlock(&scan->lock);
+
+	for (int i = 0; i < scan->num_workers; i++) {
+		pdo_mimer_scan_worker *worker = &scan->workers[i];
+
+		if (worker->is_running)
+			pdo_mimer_thread_join(worker->thread);
+		worker->is_running = false;
+		pdo_mimer_worker_session_release(mimer_dbh, &worker->session, &worker->error);
+		pdo_mimer_worker_error_free(&worker->error);
+	}
+}
+
+
+static void pdo_mimer_scan_free(pdo_mimer_parallel_scan *scan) {
+	for (int i = 0; i < scan->num_ranges; i++) {
+		pdo_mimer_scan_range *range = &scan->ranges[i];
+
+		for (int j = 0; j < range->num_params; j++)
+			pdo_mimer_worker_param_free(&range->params[j]);
+		free(range->params);
+		pdo_mimer_rows_free(&range->rows);
+		pdo_mimer_worker_error_free(&range->error);
+	}
+
+	pdo_mimer_worker_names_release(scan->names, scan->num_columns);
+	pdo_mimer_strings_free(&scan->strings);
+	pdo_mimer_worker_column_names_free(scan->column_names, scan->num_columns);
+	pdo_mimer_cond_destroy(&scan->cond);
+	pdo_mimer_mutex_destroy(&scan->lock);
+	free(scan->completed);
+	free(scan->ranges);
+	free(scan->workers);
+	free(scan->sql);
+	free(scan);
+}
+
+
+/**
+ * @brief Reads the next row of a scan, waiting for its range to be fetched.
+ * @param rows [out] The rows the row is in.
+ * @param row [out] The number of the row in @p rows.
+ * @return PDO_MIMER_SCAN_ROW, PDO_MIMER_SCAN_END once all rows were read, or PDO_MIMER_SCAN_FAILED if the range
+ * failed, its error then being reported according to the error mode
+ * @remark The rows of a range are freed once read, so only the range being read and the ones fetched ahead of it,
+ * at most max_pending, are held in memory.
+ */
+static pdo_mimer_scan_status pdo_mimer_scan_next(pdo_mimer_scan_result *result, const pdo_mimer_rows **rows,
+	int *row) {
+	pdo_mimer_parallel_scan *scan = result->scan;
+
+	while (!scan->is_finished) {
+		if (scan->current != NULL && scan->current_row < scan->current->rows.num_rows) {
+			*rows = &scan->current->rows;
+			*row = scan->current_row++;
+			return PDO_MIMER_SCAN_ROW;
+		}
+
+		if (scan->current != NULL) {
+			pdo_mimer_rows_free(&scan->current->rows);
+			scan->current = NULL;
+		}
+
+		if (scan->num_read == scan->num_ranges) {
+			scan->is_finished = true;
+			break;
+		}
+
+		pdo_mimer_mutex_lock(&scan->lock);
+		if (scan->is_ordered) {
+			while (!scan->ranges[scan->num_read].is_done)
+				pdo_mimer_cond_wait(&scan->cond, &scan->lock);
+			scan->current = &scan->ranges[scan->num_read];
+		} else {
+			while (scan->num_read >= scan->num_completed)
+				pdo_mimer_cond_wait(&scan->cond, &scan->lock);
+			scan->current = &scan->ranges[scan->completed[scan->num_read]];
+		}
+		/* makes room for the workers to take another range */
+		scan->num_read++;
+		pdo_mimer_cond_broadcast(&scan->cond);
+		pdo_mimer_mutex_unlock(&scan->lock);
+
+		scan->current_row = 0;
+
+		if (scan->current->error.code != MIMER_SUCCESS) {
+			pdo_dbh_t *dbh = php_pdo_dbh_fetch_inner(result->dbh_object);
+
+			scan->is_finished = true;
+			pdo_mimer_scan_stop(scan, dbh->driver_data);
+			pdo_mimer_worker_set_error(dbh, &scan->current->error);
+			pdo_handle_error(dbh, NULL);
+			return PDO_MIMER_SCAN_FAILED;
+		}
+	}
+
+	return PDO_MIMER_SCAN_END;
+}
+
+
+/**
+ * @brief Builds the zval of a row read from a scan, keyed by column name or number.
+ */
+static void pdo_mimer_scan_row_zval(pdo_mimer_scan_result *result, const pdo_mimer_rows *rows, int row,
+	zend_long mode, zval *zv) {
+	pdo_mimer_parallel_scan *scan = result->scan;
+
+	if (mode == PDO_FETCH_ASSOC && scan->names == NULL) {
+		/* a range with rows has been read, so the names were set under the lock */
+		pdo_mimer_mutex_lock(&scan->lock);
+		scan->names = pdo_mimer_worker_names_init(php_pdo_dbh_fetch_inner(result->dbh_object)->driver_data,
+			scan->column_names, scan->num_columns);
+		pdo_mimer_mutex_unlock(&scan->lock);
+	}
+
+	pdo_mimer_worker_row_zval(rows, row, mode == PDO_FETCH_ASSOC ? scan->names : NULL, &scan->strings, zv);
+}
+
+
+static zend_object *pdo_mimer_scan_result_create(zend_class_entry *ce) {
+	pdo_mimer_scan_result *result = zend_object_alloc(sizeof(pdo_mimer_scan_result), ce);
+
+	zend_object_std_init(&result->std, ce);
+	object_properties_init(&result->std, ce);
+	result->std.handlers = &pdo_mimer_scan_result_handlers;
+
+	return &result->std;
+}
+
+
+static void pdo_mimer_scan_result_free(zend_object *obj) {
+	pdo_mimer_scan_result *result = pdo_mimer_scan_result_from_obj(obj);
+
+	if (result->scan != NULL) {
+		/* at shutdown the connection may have been freed first */
+		pdo_mimer_scan_stop(result->scan, OBJ_FLAGS(result->dbh_object) & IS_OBJ_FREE_CALLED ? NULL :
+			php_pdo_dbh_fetch_inner(result->dbh_object)->driver_data);
+		pdo_mimer_scan_free(result->scan);
+		OBJ_RELEASE(result->dbh_object);
+	}
+
+	zend_object_std_dtor(obj);
+}
+
+
+static zend_function *pdo_mimer_scan_result_get_constructor(zend_object *object) {
+	zend_throw_error(NULL, "Cannot directly construct MimerScanResult, use PDO::mimerParallelScan() instead");
+	return NULL;
+}
+
+
+/**
+ * @brief Registers the <code>MimerScanResult</code> class.
+ */
+void pdo_mimer_parallel_register_class(void) {
+	pdo_mimer_scan_result_ce = register_class_MimerScanResult();
+	pdo_mimer_scan_result_ce->create_object = pdo_mimer_scan_result_create;
+
+	memcpy(&pdo_mimer_scan_result_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	pdo_mimer_scan_result_handlers.offset = XtOffsetOf(pdo_mimer_scan_result, std);
+	pdo_mimer_scan_result_handlers.free_obj = pdo_mimer_scan_result_free;
+	pdo_mimer_scan_result_handlers.get_constructor = pdo_mimer_scan_result_get_constructor;
+	pdo_mimer_scan_result_handlers.clone_obj = NULL;
+}
+
+
+/**
+ * @brief The PHP method <code>mimerParallelScan()</code> extends the <code>PDO</code> class to run a query once per
+ * range, such as a range of keys, on several sessions at once.
+ * @param sql [in] The query, with positional placeholders for the range predicate.
+ * @param ranges [in] The values of the placeholders for each range, arrays of scalars or null.
+ * @param threads [in] The number of worker threads and sessions, between 1 and PDO_MIMER_PARALLEL_MAX_SESSIONS.
+ * @param options [in] <code>ordered</code>: read the rows in the order of the ranges (the default), or as the ranges
+ * complete. <code>max_pending</code>: the most ranges the workers fetch ahead of the reader, twice the number of
+ * threads by default. <code>PDO::MIMER_ATTR_TRIM_CHAR</code> and <code>PDO::MIMER_ATTR_DEDUP_STRINGS</code>, applied
+ * to the rows as for a statement.
+ * @param return_value [out] A <code>MimerScanResult</code> to read the rows from.
+ * @remark The workers take sessions from the connection's pool, or begin new ones with the connection's credentials,
+ * and run outside of its transaction. Rows are decoded by the workers like the prefetch thread does, and only turned
+ * into zvals as they are read.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerParallelScan) {
+	pdo_dbh_t *dbh = Z_PDO_DBH_P(ZEND_THIS);
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+	zend_string *sql;
+	HashTable *ranges, *options = NULL;
+	zend_long threads = 4;
+	zval *range_zv, *value;
+
+	ZEND_PARSE_PARAMETERS_START(2, 4)
+		Z_PARAM_STR(sql)
+		Z_PARAM_ARRAY_HT(ranges)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(threads)
+		Z_PARAM_ARRAY_HT(options)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (threads < 1 || threads > PDO_MIMER_PARALLEL_MAX_SESSIONS) {
+		zend_argument_value_error(3, "must be between 1 and %d", PDO_MIMER_PARALLEL_MAX_SESSIONS);
+		RETURN_THROWS();
+	}
+
+	zend_long max_pending = pdo_mimer_option_long(options, "max_pending", 2 * threads);
+	if (max_pending < 1) {
+		zend_argument_value_error(4, "option \"max_pending\" must be greater than 0");
+		RETURN_THROWS();
+	}
+
+	pdo_mimer_parallel_scan *scan = calloc(1, sizeof(pdo_mimer_parallel_scan));
+	if (scan == NULL) {
+		zend_throw_error(NULL, "Out of memory");
+		RETURN_THROWS();
+	}
+
+	pdo_mimer_mutex_init(&scan->lock);
+	pdo_mimer_cond_init(&scan->cond);
+	scan->is_ordered = pdo_mimer_option_bool(options, "ordered", true);
+	pdo_mimer_strings_init(&scan->strings, options);
+	scan->num_ranges = (int) MIN(zend_hash_num_elements(ranges), INT_MAX);
+	scan->num_workers = (int) MIN(threads, scan->num_ranges);
+	scan->max_pending = (int) MIN(max_pending, INT_MAX);
+
+	bool is_ok = (scan->sql = pdo_mimer_worker_strdup(ZSTR_VAL(sql), ZSTR_LEN(sql))) != NULL &&
+		(scan->ranges = calloc(scan->num_ranges + 1, sizeof(pdo_mimer_scan_range))) != NULL &&
+		(scan->completed = calloc(scan->num_ranges + 1, sizeof(int))) != NULL &&
+		(scan->workers = calloc(scan->num_workers + 1, sizeof(pdo_mimer_scan_worker))) != NULL;
+	bool is_valid = true;
+	int index = 0;
+
+	ZEND_HASH_FOREACH_VAL(ranges, range_zv) {
+		pdo_mimer_scan_range *range = &scan->ranges[index++];
+
+		ZVAL_DEREF(range_zv);
+		if (!is_ok || !(is_valid = Z_TYPE_P(range_zv) == IS_ARRAY))
+			break;
+
+		is_ok = (range->params = calloc(zend_hash_num_elements(Z_ARRVAL_P(range_zv)) + 1,
+			sizeof(pdo_mimer_worker_param))) != NULL;
+
+		ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(range_zv), value) {
+			ZVAL_DEREF(value);
+			if (!is_ok || !(is_valid = Z_TYPE_P(value) <= IS_STRING))
+				break;
+			is_ok = pdo_mimer_worker_param_init(&range->params[range->num_params++], value);
+		} ZEND_HASH_FOREACH_END();
+
+		if (!is_valid)
+			break;
+	} ZEND_HASH_FOREACH_END();
+
+	for (int i = 0; i < scan->num_workers && is_ok && is_valid; i++) {
+		scan->workers[i].scan = scan;
+		is_ok = pdo_mimer_worker_session_take(dbh, &scan->workers[i].session);
+	}
+
+	if (!is_ok || !is_valid) {
+		pdo_mimer_scan_stop(scan, mimer_dbh);
+		pdo_mimer_scan_free(scan);
+		if (!is_valid)
+			zend_argument_type_error(2, "must contain only arrays of scalar or null values");
+		else
+			zend_throw_error(NULL, "Out of memory");
+		RETURN_THROWS();
+	}
+
+	object_init_ex(return_value, pdo_mimer_scan_result_ce);
+	pdo_mimer_scan_result *result = Z_MIMER_SCAN_RESULT_P(return_value);
+	result->scan = scan;
+	result->dbh_object = Z_OBJ_P(ZEND_THIS);
+	GC_ADDREF(result->dbh_object);
+
+	int num_started = 0;
+	for (int i = 0; i < scan->num_workers; i++) {
+		pdo_mimer_scan_worker *worker = &scan->workers[i];
+
+		if ((worker->is_running = pdo_mimer_thread_create(&worker->thread, pdo_mimer_scan_main, worker)))
+			num_started++;
+	}
+
+	/* without any thread the ranges are all fetched here, before the reader runs */
+	if (num_started == 0 && scan->num_workers > 0) {
+		scan->max_pending = scan->num_ranges;
+		pdo_mimer_scan_main(&scan->workers[0]);
+	}
+}
+
+
+/**
+ * @brief The PHP method <code>MimerScanResult::fetch()</code> returns the next row of the scan, waiting for its range
+ * to be fetched.
+ * @param mode [in] PDO::FETCH_ASSOC or PDO::FETCH_NUM.
+ * @param return_value [out] The row, or false after the last row or if its range failed.
+ */
+PHP_METHOD(MimerScanResult, fetch) {
+	pdo_mimer_scan_result *result = Z_MIMER_SCAN_RESULT_P(ZEND_THIS);
+	zend_long mode = PDO_FETCH_ASSOC;
+	const pdo_mimer_rows *rows;
+	int row;
+
+	ZEND_PARSE_PARAMETERS_START(0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(mode)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (mode != PDO_FETCH_ASSOC && mode != PDO_FETCH_NUM) {
+		zend_argument_value_error(1, "must be either PDO::FETCH_ASSOC or PDO::FETCH_NUM");
+		RETURN_THROWS();
+	}
+
+	if (pdo_mimer_scan_next(result, &rows, &row) != PDO_MIMER_SCAN_ROW)
+		RETURN_FALSE;
+
+	pdo_mimer_scan_row_zval(result, rows, row, mode, return_value);
+}
+
+
+/**
+ * @brief The PHP method <code>MimerScanResult::fetchAll()</code> returns the rows of the scan not read yet.
+ * @param mode [in] PDO::FETCH_ASSOC or PDO::FETCH_NUM.
+ * @param return_value [out] The rows, or false if one of their ranges failed.
+ */
+PHP_METHOD(MimerScanResult, fetchAll) {
+	pdo_mimer_scan_result *result = Z_MIMER_SCAN_RESULT_P(ZEND_THIS);
+	zend_long mode = PDO_FETCH_ASSOC;
+	pdo_mimer_scan_status status;
+	const pdo_mimer_rows *rows;
+	int row;
+
+	ZEND_PARSE_PARAMETERS_START(0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(mode)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (mode != PDO_FETCH_ASSOC && mode != PDO_FETCH_NUM) {
+		zend_argument_value_error(1, "must be either PDO::FETCH_ASSOC or PDO::FETCH_NUM");
+		RETURN_THROWS();
+	}
+
+	array_init(return_value);
+
+	while ((status = pdo_mimer_scan_next(result, &rows, &row)) == PDO_MIMER_SCAN_ROW) {
+		zval entry;
+
+		pdo_mimer_scan_row_zval(result, rows, row, mode, &entry);
+		zend_hash_next_index_insert_new(Z_ARRVAL_P(return_value), &entry);
+	}
+
+	if (status == PDO_MIMER_SCAN_FAILED) {
+		zval_ptr_dtor(return_value);
+		RETURN_FALSE;
+	}
+}
@@ -0,0 +1,14 @@
+<?php
+
+/** @generate-class-entries */
+
+/**
+ * @strict-properties
+ * @not-serializable
+ */
+final class MimerScanResult {
+
+    public function fetch(int $mode = PDO::FETCH_ASSOC): array|false {}
+
+    public function fetchAll(int $mode = PDO::FETCH_ASSOC): array|false {}
+}
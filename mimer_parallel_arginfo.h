@@ -0,0 +1,30 @@
+/* This is a generated file, edit the .stub.php file instead.
+ * Stub hash: d727cbdfdb1bab19e526cc371f240c5bced1aa95 */
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_class_MimerScanResult_fetch, 0, 0, MAY_BE_ARRAY|MAY_BE_FALSE)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, mode, IS_LONG, 0, "PDO::FETCH_ASSOC")
+ZEND_END_ARG_INFO()
+
+#define arginfo_class_MimerScanResult_fetchAll arginfo_class_MimerScanResult_fetch
+
+
+ZEND_METHOD(MimerScanResult, fetch);
+ZEND_METHOD(MimerScanResult, fetchAll);
+
+
+static const zend_function_entry class_MimerScanResult_methods[] = {
+	ZEND_ME(MimerScanResult, fetch, arginfo_class_MimerScanResult_fetch, ZEND_ACC_PUBLIC)
+	ZEND_ME(MimerScanResult, fetchAll, arginfo_class_MimerScanResult_fetchAll, ZEND_ACC_PUBLIC)
+	ZEND_FE_END
+};
+
+static zend_class_entry *register_class_MimerScanResult(void)
+{
+	zend_class_entry ce, *class_entry;
+
+	INIT_CLASS_ENTRY(ce, "MimerScanResult", class_MimerScanResult_methods);
+	class_entry = zend_register_internal_class_ex(&ce, NULL);
+	class_entry->ce_flags |= ZEND_ACC_FINAL|ZEND_ACC_NO_DYNAMIC_PROPERTIES|ZEND_ACC_NOT_SERIALIZABLE;
+
+	return class_entry;
+}
@@ -0,0 +1,652 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "pdo/php_pdo.h"
+#include "pdo/php_pdo_driver.h"
+#include "php_pdo_mimer.h"
+#include "php_pdo_mimer_int.h"
+#include "pdo_mimer_thread.h"
+
+/* buffer size for DECIMAL and datetime values */
+#define PDO_MIMER_DECIMAL_CHARS 100
+
+/* rows there is room for at first, the buffers then double as needed */
+#define PDO_MIMER_ROWS_MIN_SIZE 64
+#define PDO_MIMER_ROWS_MIN_DATA_SIZE 4096
+
+/**
+ * @brief Rows decoded by the prefetch thread, handed to the PHP thread as a whole.
+ */
+typedef struct pdo_mimer_prefetch_batch_t {
+	pdo_mimer_rows rows;
+	MimerReturnCode end_code;         /* MIMER_SUCCESS if the result set goes on after the batch */
+	bool is_ready;                    /* filled, and owned by the PHP thread until it has read it */
+} pdo_mimer_prefetch_batch;
+
+/**
+ * @brief A thread fetching the rows of a statement ahead of the PHP thread, into two batches used in turns.
+ * @remark The thread owns the statement's session while it runs. It is paused whenever the PHP thread needs the
+ * session, and resumed when the rows already fetched have been read.
+ */
+struct pdo_mimer_prefetch_t {
+	pdo_mimer_mutex lock;
+	pdo_mimer_cond cond;
+	pdo_mimer_thread thread;
+	MimerStatement statement;
+	int batch_rows;
+	bool is_stopping;
+	pdo_mimer_prefetch_batch batches[2];
+
+	/* whoever fills the batches: the thread while it runs, the PHP thread otherwise */
+	int filling;     /* batch to fill next */
+	int rows;        /* rows to fetch into it */
+	bool has_ended;  /* the result set has been fetched to its end */
+
+	/* PHP thread only */
+	bool is_running; /* the thread has been started and not joined */
+	int current;     /* batch being read */
+	bool has_batch;  /* the current batch is ready and being read */
+	int row;         /* row being read in the current batch */
+};
+
+
+/**
+ * @brief Tells whether values of a column type are read by <code>pdo_mimer_value_decode()</code>.
+ * @remark LOBs are read through their handles by the PHP thread, so they are not.
+ */
+bool pdo_mimer_value_is_decodable(int32_t column_type) {
+	if (MimerIsBlob(column_type) || MimerIsClob(column_type) || MimerIsNclob(column_type))
+		return false;
+
+	return MimerIsInt64(column_type) || MimerIsInt32(column_type) || MimerIsBoolean(column_type) ||
+		MimerIsFloat(column_type) || MimerIsDouble(column_type) || MimerIsBinary(column_type) ||
+		MimerIsDecimal(column_type) || MimerIsDatetime(column_type) || MimerIsString(column_type);
+}
+
+
+/**
+ * @brief Prepares a buffer for the rows of a statement's result set.
+ * @param rows [out] The buffer.
+ * @param statement [in] The statement, its cursor open or not.
+ * @param num_columns [in] The number of columns of the result set.
+ * @return MIMER_SUCCESS, PDO_MIMER_UNKNOWN_COLUMN_TYPE if a column cannot be decoded off the PHP thread,
+ * PDO_MIMER_OUT_OF_MEMORY, or the error reading the column types
+ * @remark Safe to call from any thread. The buffer is to be freed with <code>pdo_mimer_rows_free()</code>, whatever
+ * the outcome.
+ */
+MimerReturnCode pdo_mimer_rows_init(pdo_mimer_rows *rows, MimerStatement statement, int num_columns) {
+	*rows = (pdo_mimer_rows) { .num_columns = num_columns };
+
+	if (num_columns > 0 && (rows->column_types = malloc(num_columns * sizeof(int32_t))) == NULL)
+		return PDO_MIMER_OUT_OF_MEMORY;
+
+	for (int16_t colno = 1; colno <= num_columns; colno++) {
+		int32_t column_type = MimerColumnType(statement, colno);
+
+		if (!MIMER_SUCCEEDED(column_type))
+			return column_type;
+		if (!pdo_mimer_value_is_decodable(column_type))
+			return PDO_MIMER_UNKNOWN_COLUMN_TYPE;
+
+		rows->column_types[colno - 1] = column_type;
+	}
+
+	return MIMER_SUCCESS;
+}
+
+
+/**
+ * @brief Makes room for a value's bytes.
+ * @return The offset of the room in the rows' data, or -1 if out of memory.
+ */
+static ssize_t pdo_mimer_rows_reserve(pdo_mimer_rows *rows, size_t len) {
+	if (rows->data_used + len > rows->data_size) {
+		size_t size = MAX(rows->data_size, PDO_MIMER_ROWS_MIN_DATA_SIZE);
+		while (size < rows->data_used + len)
+			size *= 2;
+
+		char *data = realloc(rows->data, size);
+		if (data == NULL)
+			return -1;
+
+		rows->data = data;
+		rows->data_size = size;
+	}
+
+	rows->data_used += len;
+	return (ssize_t) (rows->data_used - len);
+}
+
+
+/**
+ * @brief Decodes a value of the row a statement has just fetched, or of an output parameter. All values but LOBs are
+ * read from the API through here, by the PHP thread as well as by the threads decoding rows ahead of it.
+ * @param rows [in|out] The buffer the value's bytes are added to.
+ * @param statement [in] The statement.
+ * @param colno [in] The one-indexed column or parameter number.
+ * @param column_type [in] The type of the column, one <code>pdo_mimer_value_is_decodable()</code> accepts.
+ * @param value [out] The value.
+ * @return MIMER_SUCCESS, or an error code
+ * @remark Safe to call from any thread.
+ */
+MimerReturnCode pdo_mimer_value_decode(pdo_mimer_rows *rows, MimerStatement statement, int16_t colno,
+	int32_t column_type, pdo_mimer_value *value) {
+	MimerReturnCode return_code;
+	ssize_t offset;
+
+	*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_NULL };
+
+	if ((return_code = MimerIsNull(statement, colno)) != 0)
+		return return_code > 0 ? MIMER_SUCCESS : return_code;
+
+	if (MimerIsInt64(column_type)) {
+		int64_t data;
+		return_code = MimerGetInt64(statement, colno, &data);
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_LONG, .u.lval = data };
+	}
+
+	else if (MimerIsInt32(column_type)) {
+		int32_t data;
+		return_code = MimerGetInt32(statement, colno, &data);
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_LONG, .u.lval = data };
+	}
+
+	else if (MimerIsBoolean(column_type)) {
+		return_code = MimerGetBoolean(statement, colno);
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_BOOL, .u.lval = return_code };
+	}
+
+	else if (MimerIsFloat(column_type)) {
+		float data;
+		return_code = MimerGetFloat(statement, colno, &data);
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_DOUBLE, .u.dval = data };
+	}
+
+	else if (MimerIsDouble(column_type)) {
+		double data;
+		return_code = MimerGetDouble(statement, colno, &data);
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_DOUBLE, .u.dval = data };
+	}
+
+	else if (MimerIsBinary(column_type)) {
+		if (!MIMER_SUCCEEDED(return_code = MimerGetBinary(statement, colno, NULL, 0)))
+			return return_code;
+		if ((offset = pdo_mimer_rows_reserve(rows, return_code)) < 0)
+			return PDO_MIMER_OUT_OF_MEMORY;
+
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_BYTES, .len = return_code, .u.offset = offset };
+		return_code = MimerGetBinary(statement, colno, rows->data + offset, value->len);
+	}
+
+	else if (MimerIsDecimal(column_type) || MimerIsDatetime(column_type)) {
+		/* the API cannot tell the length of these types, so they are read into a buffer large enough for any */
+		if ((offset = pdo_mimer_rows_reserve(rows, PDO_MIMER_DECIMAL_CHARS)) < 0)
+			return PDO_MIMER_OUT_OF_MEMORY;
+
+		char *str = rows->data + offset;
+		*str = '\0';
+		return_code = MimerGetString8(statement, colno, str, PDO_MIMER_DECIMAL_CHARS);
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_BYTES, .len = strlen(str), .u.offset = offset };
+	}
+
+	else {
+		if (!MIMER_SUCCEEDED(return_code = MimerGetString8(statement, colno, NULL, 0)))
+			return return_code;
+		/* +1 for the null-terminator the API writes */
+		if ((offset = pdo_mimer_rows_reserve(rows, return_code + 1)) < 0)
+			return PDO_MIMER_OUT_OF_MEMORY;
+
+		*value = (pdo_mimer_value) { .kind = PDO_MIMER_VALUE_BYTES, .len = return_code, .is_string = true,
+			.is_padded = MimerIsPadded(column_type), .u.offset = offset };
+		return_code = MimerGetString8(statement, colno, rows->data + offset, value->len + 1);
+	}
+
+	return MIMER_SUCCEEDED(return_code) ? MIMER_SUCCESS : return_code;
+}
+
+
+/**
+ * @brief Decodes the row a statement has just fetched, after the rows already in the buffer.
+ * @param rows [in|out] The buffer, prepared for the statement.
+ * @param statement [in] The statement.
+ * @return MIMER_SUCCESS, or an error code
+ * @remark Safe to call from any thread.
+ */
+MimerReturnCode pdo_mimer_rows_add(pdo_mimer_rows *rows, MimerStatement statement) {
+	MimerReturnCode return_code;
+
+	if ((size_t) (rows->num_rows + 1) * rows->num_columns > rows->values_size) {
+		size_t size = MAX(rows->values_size * 2, (size_t) PDO_MIMER_ROWS_MIN_SIZE * rows->num_columns);
+		pdo_mimer_value *values = realloc(rows->values, size * sizeof(pdo_mimer_value));
+		if (values == NULL)
+			return PDO_MIMER_OUT_OF_MEMORY;
+
+		rows->values = values;
+		rows->values_size = size;
+	}
+
+	pdo_mimer_value *values = &rows->values[rows->num_rows * rows->num_columns];
+
+	for (int16_t colno = 1; colno <= rows->num_columns; colno++) {
+		if ((return_code = pdo_mimer_value_decode(rows, statement, colno, rows->column_types[colno - 1],
+			&values[colno - 1])) != MIMER_SUCCESS)
+			return return_code;
+	}
+
+	rows->num_rows++;
+	return MIMER_SUCCESS;
+}
+
+
+/**
+ * @brief Gets a value from the rows in a buffer.
+ * @param rows [in] The buffer.
+ * @param row [in] The zero-indexed row number.
+ * @param colno [in] The zero-indexed column number.
+ * @param bytes [out] The bytes of the value, if it has any.
+ * @return The value
+ */
+const pdo_mimer_value *pdo_mimer_rows_get(const pdo_mimer_rows *rows, int row, int colno, const char **bytes) {
+	const pdo_mimer_value *value = &rows->values[row * rows->num_columns + colno];
+
+	*bytes = value->kind == PDO_MIMER_VALUE_BYTES ? rows->data + value->u.offset : NULL;
+	return value;
+}
+
+
+/**
+ * @brief Finds the length of a CHAR or NCHAR value without its padding.
+ * @param str [in] The value.
+ * @param len [in] The length of @p str in bytes.
+ * @return The length of @p str without trailing spaces
+ */
+static inline size_t pdo_mimer_trimmed_len(const char *str, size_t len) {
+	while (len > 0 && str[len - 1] == ' ')
+		len--;
+	return len;
+}
+
+
+/**
+ * @brief Reads <code>PDO::MIMER_ATTR_TRIM_CHAR</code> and <code>PDO::MIMER_ATTR_DEDUP_STRINGS</code>.
+ * @param strings [out] How string values are to be converted.
+ * @param options [in] The driver options given to prepare(), or the options of a query run by worker threads, may be
+ * NULL.
+ */
+void pdo_mimer_strings_init(pdo_mimer_strings *strings, HashTable *options) {
+	zval driver_options;
+
+	*strings = (pdo_mimer_strings) { 0 };
+	if (options == NULL)
+		return;
+
+	ZVAL_ARR(&driver_options, options);
+	strings->is_char_trimmed = pdo_attr_lval(&driver_options, MIMER_ATTR_TRIM_CHAR, 0) != 0;
+	strings->is_deduped = pdo_attr_lval(&driver_options, MIMER_ATTR_DEDUP_STRINGS, 0) != 0;
+}
+
+
+/**
+ * @brief Frees the values kept for <code>PDO::MIMER_ATTR_DEDUP_STRINGS</code>, the settings are kept.
+ */
+void pdo_mimer_strings_free(pdo_mimer_strings *strings) {
+	if (strings->columns == NULL)
+		return;
+
+	for (int i = 0; i < strings->num_columns; i++) {
+		if (!strings->columns[i].is_off)
+			zend_hash_destroy(&strings->columns[i].values);
+	}
+
+	efree(strings->columns);
+	strings->columns = NULL;
+	strings->num_columns = 0;
+}
+
+
+/**
+ * @brief Gets the values kept for a column by <code>PDO::MIMER_ATTR_DEDUP_STRINGS</code>.
+ * @param strings [in] The settings the values are kept with.
+ * @param colno [in] The zero-indexed column number.
+ * @return The column's values, or NULL if the column is no longer deduplicated
+ * @remark A column is no longer deduplicated when, after <code>PDO_MIMER_DEDUP_PROBE</code> lookups, fewer than
+ * half of them found the value.
+ */
+static pdo_mimer_dedup_column *pdo_mimer_dedup_column_of(pdo_mimer_strings *strings, int colno) {
+	if (colno >= strings->num_columns) {
+		strings->columns = safe_erealloc(strings->columns, colno + 1, sizeof(pdo_mimer_dedup_column), 0);
+		for (int i = strings->num_columns; i <= colno; i++) {
+			memset(&strings->columns[i], 0, sizeof(pdo_mimer_dedup_column));
+			zend_hash_init(&strings->columns[i].values, 8, NULL, ZVAL_PTR_DTOR, false);
+		}
+		strings->num_columns = colno + 1;
+	}
+
+	return strings->columns[colno].is_off ? NULL : &strings->columns[colno];
+}
+
+
+/**
+ * @brief Looks up a value among the values kept for its column, adding it if it is not there.
+ * @param column [in] The column's values.
+ * @param str [in] The value.
+ * @param len [in] The length of @p str in bytes, at most <code>PDO_MIMER_DEDUP_MAX_LEN</code>.
+ * @return A new reference to the string kept for the value
+ */
+static zend_string *pdo_mimer_dedup_lookup(pdo_mimer_dedup_column *column, const char *str, size_t len) {
+	zend_string *shared;
+	zval *entry = zend_hash_str_find(&column->values, str, len);
+	column->lookups++;
+
+	if (entry != NULL) {
+		column->hits++;
+		shared = zend_string_copy(Z_STR_P(entry));
+	} else {
+		zval zv;
+
+		if (zend_hash_num_elements(&column->values) >= PDO_MIMER_DEDUP_SIZE)
+			zend_hash_clean(&column->values);
+
+		/* the value is its own key, so the table holds one string per value */
+		ZVAL_STRINGL(&zv, str, len);
+		zend_hash_add_new(&column->values, Z_STR(zv), &zv);
+		shared = zend_string_copy(Z_STR(zv));
+	}
+
+	if (column->lookups == PDO_MIMER_DEDUP_PROBE && column->hits < column->lookups / 2) {
+		zend_hash_destroy(&column->values);
+		column->is_off = true;
+	}
+
+	return shared;
+}
+
+
+/**
+ * @brief Converts a decoded value into a zval. All values but LOBs are turned into zvals through here, whether read by
+ * the PHP thread or decoded ahead of it.
+ * @param value [in] The value.
+ * @param bytes [in] The bytes of the value, see <code>pdo_mimer_rows_get()</code>.
+ * @param strings [in|out] How string values are converted: trimmed of their padding and shared with the earlier rows
+ * holding the same value, with the length limit of sharing applied to the trimmed value.
+ * @param colno [in] The zero-indexed column number.
+ * @param result [out] The zval, left untouched for NULL.
+ * @remark PHP thread only.
+ */
+void pdo_mimer_value_zval(const pdo_mimer_value *value, const char *bytes, pdo_mimer_strings *strings, int colno,
+	zval *result) {
+	pdo_mimer_dedup_column *column;
+	size_t len = value->len;
+
+	switch (value->kind) {
+		case PDO_MIMER_VALUE_NULL:
+			break;
+
+		case PDO_MIMER_VALUE_LONG:
+			ZVAL_LONG(result, value->u.lval);
+			break;
+
+		case PDO_MIMER_VALUE_BOOL:
+			ZVAL_BOOL(result, value->u.lval);
+			break;
+
+		case PDO_MIMER_VALUE_DOUBLE:
+			ZVAL_DOUBLE(result, value->u.dval);
+			convert_to_string(result);
+			break;
+
+		case PDO_MIMER_VALUE_BYTES:
+			if (value->is_padded && strings->is_char_trimmed)
+				len = pdo_mimer_trimmed_len(bytes, len);
+
+			if (value->is_string && strings->is_deduped && len <= PDO_MIMER_DEDUP_MAX_LEN &&
+				(column = pdo_mimer_dedup_column_of(strings, colno)) != NULL)
+				ZVAL_STR(result, pdo_mimer_dedup_lookup(column, bytes, len));
+			else
+				ZVAL_STRINGL(result, bytes, len);
+			break;
+	}
+}
+
+
+/**
+ * @brief Empties a buffer, keeping its memory for the next rows.
+ */
+void pdo_mimer_rows_clear(pdo_mimer_rows *rows) {
+	rows->num_rows = 0;
+	rows->data_used = 0;
+}
+
+
+/**
+ * @brief Frees the memory of a buffer.
+ * @remark Safe to call from any thread.
+ */
+void pdo_mimer_rows_free(pdo_mimer_rows *rows) {
+	free(rows->column_types);
+	free(rows->values);
+	free(rows->data);
+	*rows = (pdo_mimer_rows) { 0 };
+}
+
+
+/**
+ * @brief Fetches the next batch of rows, ramping the batch size up so the first rows are not kept waiting.
+ * @return Whether the result set goes on after the batch
+ */
+static bool pdo_mimer_prefetch_fill(pdo_mimer_prefetch *prefetch) {
+	pdo_mimer_prefetch_batch *batch = &prefetch->batches[prefetch->filling];
+
+	pdo_mimer_rows_clear(&batch->rows);
+	batch->end_code = MIMER_SUCCESS;
+
+	while (batch->rows.num_rows < prefetch->rows && batch->end_code == MIMER_SUCCESS) {
+		MimerReturnCode return_code = MimerFetch(prefetch->statement);
+
+		if (return_code == MIMER_NO_DATA || !MIMER_SUCCEEDED(return_code))
+			batch->end_code = return_code;
+		else
+			batch->end_code = pdo_mimer_rows_add(&batch->rows, prefetch->statement);
+	}
+
+	prefetch->filling ^= 1;
+	prefetch->rows = MIN(prefetch->rows * 2, prefetch->batch_rows);
+	prefetch->has_ended = batch->end_code != MIMER_SUCCESS;
+
+	pdo_mimer_mutex_lock(&prefetch->lock);
+	batch->is_ready = true;
+	pdo_mimer_cond_broadcast(&prefetch->cond);
+	pdo_mimer_mutex_unlock(&prefetch->lock);
+
+	return !prefetch->has_ended;
+}
+
+
+PDO_MIMER_THREAD_FUNC(pdo_mimer_prefetch_main, arg) {
+	pdo_mimer_prefetch *prefetch = arg;
+
+	while (!prefetch->has_ended) {
+		pdo_mimer_prefetch_batch *batch = &prefetch->batches[prefetch->filling];
+
+		pdo_mimer_mutex_lock(&prefetch->lock);
+		while (batch->is_ready && !prefetch->is_stopping)
+			pdo_mimer_cond_wait(&prefetch->cond, &prefetch->lock);
+		bool is_stopping = prefetch->is_stopping;
+		pdo_mimer_mutex_unlock(&prefetch->lock);
+
+		if (is_stopping)
+			break;
+
+		pdo_mimer_prefetch_fill(prefetch);
+	}
+
+	PDO_MIMER_THREAD_RETURN;
+}
+
+
+/**
+ * @brief Starts the prefetch thread again after it has been paused.
+ * @return Whether the thread is running
+ */
+static bool pdo_mimer_prefetch_resume(pdo_mimer_prefetch *prefetch) {
+	prefetch->is_stopping = false;
+	prefetch->is_running = pdo_mimer_thread_create(&prefetch->thread, pdo_mimer_prefetch_main, prefetch);
+	return prefetch->is_running;
+}
+
+
+/**
+ * @brief Starts fetching the rows of a statement with an open cursor in a thread.
+ * @param statement [in] The statement, forward-only, which is only to be used through the prefetch until it is stopped.
+ * @param num_columns [in] The number of columns of the result set.
+ * @param rows [in] The most rows decoded ahead per batch.
+ * @return The prefetch, or NULL if the result set has columns the thread cannot decode or the thread could not be
+ * started, in which case the rows are to be fetched as usual
+ */
+pdo_mimer_prefetch *pdo_mimer_prefetch_start(MimerStatement statement, int num_columns, zend_long rows) {
+	pdo_mimer_prefetch *prefetch = pecalloc(1, sizeof(pdo_mimer_prefetch), true);
+	prefetch->statement = statement;
+	prefetch->rows = 1;
+	prefetch->batch_rows = (int) MIN(rows, INT_MAX / MAX(num_columns, 1) / (int) sizeof(pdo_mimer_value));
+
+	pdo_mimer_mutex_init(&prefetch->lock);
+	pdo_mimer_cond_init(&prefetch->cond);
+
+	if (pdo_mimer_rows_init(&prefetch->batches[0].rows, statement, num_columns) != MIMER_SUCCESS ||
+		pdo_mimer_rows_init(&prefetch->batches[1].rows, statement, num_columns) != MIMER_SUCCESS ||
+		!pdo_mimer_prefetch_resume(prefetch)) {
+		pdo_mimer_prefetch_stop(prefetch);
+		return NULL;
+	}
+
+	return prefetch;
+}
+
+
+/**
+ * @brief Moves to the next prefetched row, waiting for the thread if it has not got there yet.
+ * @param prefetch [in] The prefetch.
+ * @return MIMER_SUCCESS if there is a row, MIMER_NO_DATA at the end of the result set, or the error which ended it
+ */
+MimerReturnCode pdo_mimer_prefetch_next(pdo_mimer_prefetch *prefetch) {
+	pdo_mimer_prefetch_batch *batch = &prefetch->batches[prefetch->current];
+
+	if (prefetch->has_batch) {
+		if (++prefetch->row < batch->rows.num_rows)
+			return MIMER_SUCCESS;
+
+		if (batch->end_code != MIMER_SUCCESS) {
+			prefetch->row = batch->rows.num_rows;
+			return batch->end_code;
+		}
+
+		/* give the batch back to be filled again */
+		pdo_mimer_mutex_lock(&prefetch->lock);
+		batch->is_ready = false;
+		pdo_mimer_cond_broadcast(&prefetch->cond);
+		pdo_mimer_mutex_unlock(&prefetch->lock);
+
+		prefetch->current ^= 1;
+		prefetch->has_batch = false;
+		batch = &prefetch->batches[prefetch->current];
+	}
+
+	/* the thread was paused before it got to the batch, it is fetched here if the thread cannot run again */
+	if (!prefetch->is_running && !batch->is_ready && !pdo_mimer_prefetch_resume(prefetch))
+		pdo_mimer_prefetch_fill(prefetch);
+
+	pdo_mimer_mutex_lock(&prefetch->lock);
+	while (!batch->is_ready)
+		pdo_mimer_cond_wait(&prefetch->cond, &prefetch->lock);
+	pdo_mimer_mutex_unlock(&prefetch->lock);
+
+	prefetch->has_batch = true;
+	prefetch->row = 0;
+
+	return batch->rows.num_rows > 0 ? MIMER_SUCCESS : batch->end_code;
+}
+
+
+/**
+ * @brief Gets a value of the current prefetched row.
+ * @param prefetch [in] The prefetch.
+ * @param colno [in] The zero-indexed column number.
+ * @param bytes [out] The bytes of the value, if it has any.
+ * @return The value
+ */
+const pdo_mimer_value *pdo_mimer_prefetch_get(pdo_mimer_prefetch *prefetch, int colno, const char **bytes) {
+	return pdo_mimer_rows_get(&prefetch->batches[prefetch->current].rows, prefetch->row, colno, bytes);
+}
+
+
+/**
+ * @brief Gets the type of a prefetched column.
+ * @param prefetch [in] The prefetch.
+ * @param colno [in] The zero-indexed column number.
+ */
+int32_t pdo_mimer_prefetch_column_type(const pdo_mimer_prefetch *prefetch, int colno) {
+	return prefetch->batches[prefetch->current].rows.column_types[colno];
+}
+
+
+/**
+ * @brief Pauses the prefetch thread, so the statement's session can be used by the PHP thread.
+ * @param prefetch [in] The prefetch.
+ * @remark The thread finishes the batch it is filling, if any, before it stops. The rows already fetched are kept, and
+ * the thread is started again once they have been read.
+ */
+void pdo_mimer_prefetch_pause(pdo_mimer_prefetch *prefetch) {
+	if (!prefetch->is_running)
+		return;
+
+	pdo_mimer_mutex_lock(&prefetch->lock);
+	prefetch->is_stopping = true;
+	pdo_mimer_cond_broadcast(&prefetch->cond);
+	pdo_mimer_mutex_unlock(&prefetch->lock);
+
+	pdo_mimer_thread_join(prefetch->thread);
+	prefetch->is_running = false;
+}
+
+
+/**
+ * @brief Stops the prefetch thread and frees the prefetch, the statement can be used again afterwards.
+ * @param prefetch [in] The prefetch.
+ */
+void pdo_mimer_prefetch_stop(pdo_mimer_prefetch *prefetch) {
+	pdo_mimer_prefetch_pause(prefetch);
+
+	pdo_mimer_cond_destroy(&prefetch->cond);
+	pdo_mimer_mutex_destroy(&prefetch->lock);
+
+	pdo_mimer_rows_free(&prefetch->batches[0].rows);
+	pdo_mimer_rows_free(&prefetch->batches[1].rows);
+	pefree(prefetch, true);
+}
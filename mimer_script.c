@@ -0,0 +1,175 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "pdo/php_pdo.h"
+#include "pdo/php_pdo_driver.h"
+#include "php_pdo_mimer.h"
+#include "php_pdo_mimer_int.h"
+
+/* characters which may appear in a regular identifier or keyword */
+#define PDO_MIMER_IS_WORD_CHAR(c) (isalnum((unsigned char) (c)) || (c) == '_' || (c) == '$' || (c) == '#')
+
+/* keywords which close a control statement after END and thus do not close a compound statement */
+static const char *pdo_mimer_end_qualifiers[] = { "IF", "LOOP", "WHILE", "REPEAT", "FOR" };
+
+
+/**
+ * @brief Skips a string literal, a delimited identifier or a comment.
+ * @param p [in] Where to start, in the SQL text.
+ * @param end [in] The end of the SQL text.
+ * @return A pointer past what was skipped, or @p p if there is no literal, identifier or comment there.
+ * @remark Unterminated literals and comments extend to @p end, the server will complain about them.
+ */
+const char *pdo_mimer_sql_skip(const char *p, const char *end) {
+	if (p >= end)
+		return p;
+
+	switch (*p) {
+		case '\'':
+		case '"': {
+			char quote = *p++;
+			while (p < end) {
+				if (*p++ != quote)
+					continue;
+				if (p < end && *p == quote) { /* a doubled quote stands for itself */
+					p++;
+					continue;
+				}
+				return p;
+			}
+			return end;
+		}
+
+		case '-':
+			if (end - p > 1 && p[1] == '-') {
+				const char *eol = memchr(p, '\n', end - p);
+				return eol ? eol + 1 : end;
+			}
+			break;
+
+		case '/':
+			if (end - p > 1 && p[1] == '*') {
+				for (p += 2; end - p > 1; p++) {
+					if (p[0] == '*' && p[1] == '/')
+						return p + 2;
+				}
+				return end;
+			}
+			break;
+	}
+
+	return p;
+}
+
+
+static bool pdo_mimer_is_keyword(const char *word, size_t word_len, const char *keyword) {
+	return word_len == strlen(keyword) && !strncasecmp(word, keyword, word_len);
+}
+
+
+/**
+ * @brief Finds the next statement of an SQL script.
+ * @param cursor [in|out] Where to continue in the script, advanced past the statement and its terminating semicolon.
+ * @param end [in] The end of the script.
+ * @param stmt_end [out] The end of the statement, without the semicolon and trailing white space.
+ * @return The start of the statement, or NULL when the script holds no more statements.
+ * @remark Semicolons in literals, delimited identifiers, comments and compound statements (BEGIN ... END, as well as
+ * CASE ... END) do not end a statement. Comments in front of a statement and empty statements are skipped.
+ */
+const char *pdo_mimer_script_next(const char **cursor, const char *end, const char **stmt_end) {
+	const char *p = *cursor, *start = NULL, *last = NULL;
+	int depth = 0;
+
+	while (p < end) {
+		const char *next = pdo_mimer_sql_skip(p, end);
+
+		if (next != p) {
+			if (*p == '\'' || *p == '"') {
+				if (start == NULL)
+					start = p;
+				last = next;
+			}
+			p = next;
+			continue;
+		}
+
+		if (isspace((unsigned char) *p)) {
+			p++;
+			continue;
+		}
+
+		if (*p == ';' && depth <= 0) {
+			p++;
+			if (start == NULL) /* empty statement */
+				continue;
+
+			*cursor = p;
+			*stmt_end = last;
+			return start;
+		}
+
+		if (start == NULL)
+			start = p;
+
+		if (!PDO_MIMER_IS_WORD_CHAR(*p)) {
+			last = ++p;
+			continue;
+		}
+
+		const char *word = p;
+		while (p < end && PDO_MIMER_IS_WORD_CHAR(*p))
+			p++;
+		last = p;
+
+		if (pdo_mimer_is_keyword(word, p - word, "BEGIN") || pdo_mimer_is_keyword(word, p - word, "CASE")) {
+			depth++;
+		} else if (pdo_mimer_is_keyword(word, p - word, "END")) {
+			const char *qualifier = p, *q;
+			bool closes_control = false;
+
+			while (qualifier < end && isspace((unsigned char) *qualifier))
+				qualifier++;
+			for (q = qualifier; q < end && PDO_MIMER_IS_WORD_CHAR(*q); q++);
+
+			for (size_t i = 0; i < sizeof(pdo_mimer_end_qualifiers) / sizeof(*pdo_mimer_end_qualifiers); i++)
+				closes_control |= pdo_mimer_is_keyword(qualifier, q - qualifier, pdo_mimer_end_qualifiers[i]);
+
+			if (!closes_control) {
+				depth--;
+				if (pdo_mimer_is_keyword(qualifier, q - qualifier, "CASE")) /* END CASE closes one CASE only */
+					last = p = q;
+			}
+		}
+	}
+
+	*cursor = end;
+	*stmt_end = last;
+	return start;
+}
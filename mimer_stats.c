@@ -0,0 +1,311 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "ext/standard/info.h"
+#include "zend_smart_str.h"
+#include "pdo/php_pdo.h"
+#include "pdo/php_pdo_driver.h"
+#include "php_pdo_mimer.h"
+#include "php_pdo_mimer_int.h"
+
+/**
+ * @brief A counter of <code>pdo_mimer_stats</code> reported as a single figure.
+ */
+typedef struct {
+	const char *name;    /* key in mimerGetStats() and phpinfo() */
+	const char *metric;  /* name of the Prometheus metric */
+	const char *help;
+	size_t offset;
+	bool is_time;        /* nanoseconds, reported in milliseconds, and in seconds to Prometheus */
+} pdo_mimer_stats_counter;
+
+#define PDO_MIMER_COUNTER(name, metric, help) { #name, metric, help, offsetof(pdo_mimer_stats, name), false }
+#define PDO_MIMER_TIMER(name, field, metric, help) { #name, metric, help, offsetof(pdo_mimer_stats, field), true }
+
+static const pdo_mimer_stats_counter pdo_mimer_stats_counters[] = {
+	PDO_MIMER_COUNTER(sessions_opened, "pdo_mimer_sessions_opened_total",
+		"Sessions begun for connections and their workers."),
+	PDO_MIMER_COUNTER(prepares, "pdo_mimer_prepares_total", "Statements prepared."),
+	PDO_MIMER_COUNTER(stmt_cache_hits, "pdo_mimer_stmt_cache_hits_total",
+		"Prepares saved by reusing a statement warmed up at connect, or prepared for the same array parameters."),
+	PDO_MIMER_COUNTER(executes, "pdo_mimer_executes_total", "Statements executed."),
+	PDO_MIMER_COUNTER(rows_fetched, "pdo_mimer_rows_fetched_total", "Rows fetched."),
+	PDO_MIMER_COUNTER(bytes_in, "pdo_mimer_bytes_in_total", "Bytes of values fetched as strings, LOB values included."),
+	PDO_MIMER_COUNTER(bytes_out, "pdo_mimer_bytes_out_total", "Bytes of string, binary and LOB parameters sent."),
+	PDO_MIMER_COUNTER(lob_bytes, "pdo_mimer_lob_bytes_total", "Bytes of LOB values fetched or sent."),
+	PDO_MIMER_COUNTER(errors, "pdo_mimer_errors_total", "Errors raised."),
+	PDO_MIMER_TIMER(prepare_ms, prepare_ns, "pdo_mimer_prepare_seconds_total", "Time spent preparing statements."),
+	PDO_MIMER_TIMER(execute_ms, execute_ns, "pdo_mimer_execute_seconds_total", "Time spent executing statements."),
+	PDO_MIMER_TIMER(fetch_ms, fetch_ns, "pdo_mimer_fetch_seconds_total", "Time spent fetching rows."),
+};
+
+#undef PDO_MIMER_COUNTER
+#undef PDO_MIMER_TIMER
+
+/* names of the pdo_mimer_cell_kind values */
+static const char *pdo_mimer_cell_kind_names[PDO_MIMER_NUM_CELL_KINDS] = {
+	"null", "integer", "float", "decimal", "boolean", "character", "binary", "datetime", "lob", "other",
+};
+
+#define PDO_MIMER_STATS_VALUE(stats, counter) (*(const uint64_t *) ((const char *) (stats) + (counter)->offset))
+
+
+/**
+ * @brief Maps a character of a SQLSTATE to its position among [0-9A-Z].
+ * @return The position, or -1 for any other character.
+ */
+static int pdo_mimer_sqlstate_digit(char c) {
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'A' && c <= 'Z')
+		return c - 'A' + 10;
+	return -1;
+}
+
+
+/**
+ * @brief Counts an error by the class of its SQLSTATE, the first two characters.
+ * @remark Called only while the counters are enabled.
+ */
+void pdo_mimer_stats_error(const char *sqlstate) {
+	int high = pdo_mimer_sqlstate_digit(sqlstate[0]);
+	int low = high < 0 ? -1 : pdo_mimer_sqlstate_digit(sqlstate[1]);
+
+	PDO_MIMER_G(stats).errors++;
+	if (low >= 0)
+		PDO_MIMER_G(stats).errors_by_class[high * 36 + low]++;
+}
+
+
+/**
+ * @brief Tells the kind of cell a column of the given type holds.
+ */
+static pdo_mimer_cell_kind pdo_mimer_cell_kind_of(int32_t column_type) {
+	if (MimerIsBlob(column_type) || MimerIsClob(column_type) || MimerIsNclob(column_type))
+		return PDO_MIMER_CELL_LOB;
+	if (MimerIsInt32(column_type) || MimerIsInt64(column_type))
+		return PDO_MIMER_CELL_INTEGER;
+	if (MimerIsBoolean(column_type))
+		return PDO_MIMER_CELL_BOOLEAN;
+	if (MimerIsFloat(column_type) || MimerIsDouble(column_type))
+		return PDO_MIMER_CELL_FLOAT;
+	if (MimerIsBinary(column_type))
+		return PDO_MIMER_CELL_BINARY;
+	if (MimerIsDecimal(column_type))
+		return PDO_MIMER_CELL_DECIMAL;
+	if (MimerIsDatetime(column_type) || MimerIsInterval(column_type))
+		return PDO_MIMER_CELL_DATETIME;
+	if (MimerIsString(column_type))
+		return PDO_MIMER_CELL_CHARACTER;
+	return PDO_MIMER_CELL_OTHER;
+}
+
+
+/**
+ * @brief Counts a decoded cell by the SQL type of its column, along with the bytes of a string.
+ * @param column_type [in] The Mimer SQL type of the column.
+ * @param value [in] The value as returned to PHP.
+ * @remark Called only while the counters are enabled.
+ */
+void pdo_mimer_stats_cell(int32_t column_type, const zval *value) {
+	pdo_mimer_stats *stats = &PDO_MIMER_G(stats);
+
+	stats->cells[Z_TYPE_P(value) == IS_NULL ? PDO_MIMER_CELL_NULL : pdo_mimer_cell_kind_of(column_type)]++;
+	if (Z_TYPE_P(value) == IS_STRING)
+		stats->bytes_in += Z_STRLEN_P(value);
+}
+
+
+/**
+ * @brief Writes the two characters of a SQLSTATE class.
+ * @param index [in] The position of the class in <code>errors_by_class</code>.
+ * @param sqlstate_class [out] Room for the class and a terminating null.
+ */
+static void pdo_mimer_sqlstate_class(int index, char sqlstate_class[3]) {
+	static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+	sqlstate_class[0] = digits[index / 36];
+	sqlstate_class[1] = digits[index % 36];
+	sqlstate_class[2] = '\0';
+}
+
+
+/**
+ * @brief Prints the counters of the current thread to phpinfo(), when they are enabled.
+ */
+void pdo_mimer_stats_info(void) {
+	const pdo_mimer_stats *stats = &PDO_MIMER_G(stats);
+	char value[32], name[64];
+
+	if (!PDO_MIMER_G(stats_enabled))
+		return;
+
+	php_info_print_table_start();
+	php_info_print_table_header(2, "Mimer SQL Driver Statistics", "Value");
+
+	for (size_t i = 0; i < sizeof(pdo_mimer_stats_counters) / sizeof(pdo_mimer_stats_counters[0]); i++) {
+		const pdo_mimer_stats_counter *counter = &pdo_mimer_stats_counters[i];
+		uint64_t count = PDO_MIMER_STATS_VALUE(stats, counter);
+
+		if (counter->is_time)
+			snprintf(value, sizeof(value), "%.3f", count / 1e6);
+		else
+			snprintf(value, sizeof(value), "%" PRIu64, count);
+		php_info_print_table_row(2, counter->name, value);
+	}
+
+	for (int kind = 0; kind < PDO_MIMER_NUM_CELL_KINDS; kind++) {
+		snprintf(name, sizeof(name), "cells (%s)", pdo_mimer_cell_kind_names[kind]);
+		snprintf(value, sizeof(value), "%" PRIu64, stats->cells[kind]);
+		php_info_print_table_row(2, name, value);
+	}
+
+	for (int i = 0; i < PDO_MIMER_NUM_SQLSTATE_CLASSES; i++) {
+		char sqlstate_class[3];
+
+		if (stats->errors_by_class[i] == 0)
+			continue;
+
+		pdo_mimer_sqlstate_class(i, sqlstate_class);
+		snprintf(name, sizeof(name), "errors (SQLSTATE class %s)", sqlstate_class);
+		snprintf(value, sizeof(value), "%" PRIu64, stats->errors_by_class[i]);
+		php_info_print_table_row(2, name, value);
+	}
+
+	php_info_print_table_end();
+}
+
+
+/**
+ * @brief The PHP method <code>mimerGetStats()</code> extends the <code>PDO</code> class to return the driver's
+ * performance counters.
+ * @param reset [in] Whether to set the counters back to zero once read.
+ * @param return_value [out] The counters, along with whether counting is <code>enabled</code>.
+ * @remark The counters are those of the driver as a whole rather than of this connection. Under ZTS every thread
+ * counts on its own. Work done by worker threads is counted as it reaches PHP: the sessions begun for them, and the
+ * rows and cells they fetch once read.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerGetStats) {
+	pdo_mimer_stats *stats = &PDO_MIMER_G(stats);
+	bool reset = false;
+	zval cells, errors_by_class;
+
+	ZEND_PARSE_PARAMETERS_START(0, 1)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_BOOL(reset)
+	ZEND_PARSE_PARAMETERS_END();
+
+	array_init(return_value);
+	add_assoc_bool(return_value, "enabled", PDO_MIMER_G(stats_enabled));
+
+	for (size_t i = 0; i < sizeof(pdo_mimer_stats_counters) / sizeof(pdo_mimer_stats_counters[0]); i++) {
+		const pdo_mimer_stats_counter *counter = &pdo_mimer_stats_counters[i];
+		uint64_t count = PDO_MIMER_STATS_VALUE(stats, counter);
+
+		if (counter->is_time)
+			add_assoc_double(return_value, counter->name, count / 1e6);
+		else
+			add_assoc_long(return_value, counter->name, (zend_long) count);
+	}
+
+	array_init_size(&cells, PDO_MIMER_NUM_CELL_KINDS);
+	for (int kind = 0; kind < PDO_MIMER_NUM_CELL_KINDS; kind++)
+		add_assoc_long(&cells, pdo_mimer_cell_kind_names[kind], (zend_long) stats->cells[kind]);
+	add_assoc_zval(return_value, "cells", &cells);
+
+	array_init(&errors_by_class);
+	for (int i = 0; i < PDO_MIMER_NUM_SQLSTATE_CLASSES; i++) {
+		char sqlstate_class[3];
+		zval count;
+
+		if (stats->errors_by_class[i] == 0)
+			continue;
+
+		pdo_mimer_sqlstate_class(i, sqlstate_class);
+		ZVAL_LONG(&count, (zend_long) stats->errors_by_class[i]);
+		/* like any array key, a numeric class such as "42" becomes an integer key */
+		zend_symtable_str_update(Z_ARRVAL(errors_by_class), sqlstate_class, 2, &count);
+	}
+	add_assoc_zval(return_value, "errors_by_class", &errors_by_class);
+
+	if (reset)
+		memset(stats, 0, sizeof(*stats));
+}
+
+
+/**
+ * @brief Appends the HELP and TYPE lines of a Prometheus counter.
+ */
+static void pdo_mimer_stats_metric_header(smart_str *out, const char *metric, const char *help) {
+	smart_str_append_printf(out, "# HELP %s %s\n# TYPE %s counter\n", metric, help, metric);
+}
+
+
+/**
+ * @brief The PHP method <code>mimerExportStats()</code> extends the <code>PDO</code> class to return the driver's
+ * performance counters in the Prometheus text exposition format.
+ * @param return_value [out] The metrics, the same counters as <code>mimerGetStats()</code> returns.
+ */
+PHP_METHOD(PDO_MimerSQL_Ext, mimerExportStats) {
+	const pdo_mimer_stats *stats = &PDO_MIMER_G(stats);
+	smart_str out = {0};
+
+	ZEND_PARSE_PARAMETERS_NONE();
+
+	for (size_t i = 0; i < sizeof(pdo_mimer_stats_counters) / sizeof(pdo_mimer_stats_counters[0]); i++) {
+		const pdo_mimer_stats_counter *counter = &pdo_mimer_stats_counters[i];
+		uint64_t count = PDO_MIMER_STATS_VALUE(stats, counter);
+
+		pdo_mimer_stats_metric_header(&out, counter->metric, counter->help);
+		if (counter->is_time)
+			smart_str_append_printf(&out, "%s %.9f\n", counter->metric, count / 1e9);
+		else
+			smart_str_append_printf(&out, "%s %" PRIu64 "\n", counter->metric, count);
+	}
+
+	pdo_mimer_stats_metric_header(&out, "pdo_mimer_cells_total", "Cells decoded, by the SQL type of their column.");
+	for (int kind = 0; kind < PDO_MIMER_NUM_CELL_KINDS; kind++)
+		smart_str_append_printf(&out, "pdo_mimer_cells_total{type=\"%s\"} %" PRIu64 "\n",
+			pdo_mimer_cell_kind_names[kind], stats->cells[kind]);
+
+	pdo_mimer_stats_metric_header(&out, "pdo_mimer_sqlstate_errors_total", "Errors raised, by SQLSTATE class.");
+	for (int i = 0; i < PDO_MIMER_NUM_SQLSTATE_CLASSES; i++) {
+		char sqlstate_class[3];
+
+		if (stats->errors_by_class[i] == 0)
+			continue;
+
+		pdo_mimer_sqlstate_class(i, sqlstate_class);
+		smart_str_append_printf(&out, "pdo_mimer_sqlstate_errors_total{class=\"%s\"} %" PRIu64 "\n", sqlstate_class,
+			stats->errors_by_class[i]);
+	}
+
+	RETURN_STR(smart_str_extract(&out));
+}
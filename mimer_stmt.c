@@ -35,9 +35,14 @@
 #include "php_pdo_mimer.h"
 #include "php_pdo_mimer_int.h"
 #include "pdo_mimer_error.h"
+#include "zend_smart_str.h"
 
 static int pdo_mimer_cursor_closer(pdo_stmt_t *stmt);
 static int pdo_mimer_cursor_opener(pdo_stmt_t *stmt);
+static bool pdo_mimer_bind_arrays(pdo_stmt_t *stmt);
+static MimerReturnCode pdo_mimer_stmt_set_params(pdo_stmt_t *stmt, zval *parameter, int16_t paramno,
+	enum pdo_param_type param_type);
+static void pdo_mimer_param_error(pdo_stmt_t *stmt, MimerReturnCode return_code);
 
 
 /**
@@ -50,19 +55,54 @@ static int pdo_mimer_stmt_dtor(pdo_stmt_t *stmt) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
     int success = true;
 
+    pdo_mimer_claim_sessions(mimer_stmt->dbh);
+
     if (mimer_stmt->cursor.is_open && !pdo_mimer_cursor_closer(stmt)) {
         pdo_mimer_stmt_error();
         success = false;
     }
 
+    /* a pending error message can only be fetched while the statement is still around */
+    MimerHandle error_handle = mimer_stmt->dbh->error.handle;
+    if (error_handle != NULL && (error_handle == (MimerHandle) mimer_stmt->stmt ||
+        error_handle == (MimerHandle) mimer_stmt->routes.primary || error_handle == (MimerHandle) mimer_stmt->routes.read))
+        pdo_mimer_error_msg(stmt->dbh);
+
+    /* the statements prepared for array shapes, those as prepared are ended below */
+    if (mimer_stmt->arrays.statements != NULL) {
+        MimerStatement statement;
+        ZEND_HASH_FOREACH_PTR(mimer_stmt->arrays.statements, statement) {
+            MimerEndStatement(&statement);
+        } ZEND_HASH_FOREACH_END();
+
+        zend_hash_destroy(mimer_stmt->arrays.statements);
+        FREE_HASHTABLE(mimer_stmt->arrays.statements);
+    }
+
     /* if unable to properly end statement, throw an except since something more fatal has probably happened */
-    if (!MIMER_SUCCEEDED(MimerEndStatement(&mimer_stmt->stmt))) {
-        pdo_mimer_stmt_error();
-//        mimer_throw_except(stmt);
-//		pdo_raise_impl_error()
-        success = false;
+    MimerStatement *routes[] = { &mimer_stmt->routes.primary, &mimer_stmt->routes.read };
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++) {
+        if (*routes[i] != MIMERNULLHANDLE && !MIMER_SUCCEEDED(MimerEndStatement(routes[i]))) {
+            pdo_mimer_error_from(stmt->dbh, stmt, (MimerHandle) *routes[i], __FILE__, __LINE__);
+            pdo_mimer_error_msg(stmt->dbh);
+//            mimer_throw_except(stmt);
+//            pdo_raise_impl_error()
+            success = false;
+        }
     }
 
+    if (mimer_stmt->arrays.placeholders != NULL) {
+        efree(mimer_stmt->arrays.placeholders);
+        efree(mimer_stmt->arrays.shape);
+    }
+
+    if (mimer_stmt->scratch.buf != NULL)
+        efree(mimer_stmt->scratch.buf);
+
+    pdo_mimer_rows_free(&mimer_stmt->value);
+    pdo_mimer_strings_free(&mimer_stmt->strings);
+
+    zend_string_release(mimer_stmt->sql);
     efree(stmt->driver_data);
     stmt->driver_data = NULL;
     return success;
@@ -70,21 +110,103 @@ static int pdo_mimer_stmt_dtor(pdo_stmt_t *stmt) {
 
 
 /**
- * @brief Execute a prepared SQL statement.
+ * @brief Ends a query which ran past its <code>PDO::MIMER_ATTR_QUERY_TIMEOUT</code>.
  * @param stmt [in] A pointer to the PDOStatement handle object.
- * @return 1 upon success
- * @return 0 upon failure
- * @remark Driver is responsible for setting the column_count field in stmt for result set statements.
- *  @see <a href="https://php-legacy-docs.zend.com/manual/php5/en/internals2.pdo.pdo-stmt-t">
- *          PDO Driver How-To: pdo_stmt_t definition
- *      </a>
+ * @return 0, for the caller to return as its failure
+ * @remark The statement and its session stay usable, only the result set is closed.
  */
-static int pdo_mimer_stmt_executer(pdo_stmt_t *stmt) {
+static int pdo_mimer_stmt_timeout(pdo_stmt_t *stmt) {
+	pdo_mimer_cursor_closer(stmt);
+	pdo_mimer_custom_error(stmt, SQLSTATE_TIMEOUT_EXPIRED, PDO_MIMER_QUERY_TIMEOUT, "Query timeout expired");
+	return false;
+}
+
+
+/**
+ * @brief Moves a query to the session it runs on this time, preparing it there on first use.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @return true upon success
+ * @return false upon failure
+ * @remark Whether a query may run on the read session depends on the transaction state when it is executed, not when
+ * it was prepared, see <code>pdo_mimer_reads_may_route()</code>. Parameters already set are set again on the
+ * statement moved to, except for bound arrays which <code>pdo_mimer_bind_arrays()</code> sets anyway.
+ */
+static bool pdo_mimer_stmt_route(pdo_stmt_t *stmt) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+	bool is_on_read_session = pdo_mimer_reads_may_route(stmt->dbh);
+	MimerStatement *statement = is_on_read_session ? &mimer_stmt->routes.read : &mimer_stmt->routes.primary;
+	struct pdo_bound_param_data *param;
+
+	if (is_on_read_session == mimer_stmt->is_on_read_session)
+		return true;
+
+	if (*statement == MIMERNULLHANDLE) {
+		MimerSession session = is_on_read_session ? mimer_stmt->dbh->read_session : mimer_stmt->dbh->session;
+		MimerReturnCode return_code = MimerBeginStatement8(session, ZSTR_VAL(mimer_stmt->sql),
+			mimer_stmt->cursor.is_scrollable ? MIMER_SCROLLABLE : MIMER_FORWARD_ONLY, statement);
+		PDO_MIMER_STATS_INC(prepares);
+
+		if (!MIMER_SUCCEEDED(return_code)) {
+			pdo_mimer_error_from(stmt->dbh, stmt, (MimerHandle) session, __FILE__, __LINE__);
+			return false;
+		}
+	}
+
+	mimer_stmt->stmt = *statement;
+	mimer_stmt->is_on_read_session = is_on_read_session;
+
+	if (mimer_stmt->arrays.is_bound || stmt->bound_params == NULL)
+		return true;
+
+	ZEND_HASH_FOREACH_PTR(stmt->bound_params, param) {
+		zval *value = Z_ISREF(param->parameter) ? Z_REFVAL(param->parameter) : &param->parameter;
+
+		MimerReturnCode return_code = pdo_mimer_stmt_set_params(stmt, value, param->paramno + 1, param->param_type);
+		if (!MIMER_SUCCEEDED(return_code)) {
+			pdo_mimer_param_error(stmt, return_code);
+			return false;
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	return true;
+}
+
+
+/**
+ * @brief Executes a prepared SQL statement, see <code>pdo_mimer_stmt_executer()</code>.
+ */
+static int pdo_mimer_stmt_execute(pdo_stmt_t *stmt) {
+	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+
+	pdo_mimer_claim_sessions(mimer_stmt->dbh);
 
 	if (stmt->executed && mimer_stmt->cursor.is_open && !pdo_mimer_cursor_closer(stmt))
 		goto error;
 
+	if (mimer_stmt->is_read_query && !pdo_mimer_stmt_route(stmt))
+		return false;
+
+	if (!mimer_stmt->is_on_read_session && !pdo_mimer_ensure_transaction(stmt->dbh)) {
+		strcpy(stmt->error_code, stmt->dbh->error_code);
+		return false;
+	}
+
+	if (mimer_stmt->arrays.is_bound && !pdo_mimer_bind_arrays(stmt))
+		return false;
+
+	/* an exceptionally large value should not keep its buffer for the rest of the statement's life */
+	if (mimer_stmt->scratch.size > PDO_MIMER_SCRATCH_KEEP_SIZE) {
+		efree(mimer_stmt->scratch.buf);
+		mimer_stmt->scratch.buf = NULL;
+		mimer_stmt->scratch.size = 0;
+	}
+	if (mimer_stmt->value.data_size > PDO_MIMER_SCRATCH_KEEP_SIZE)
+		pdo_mimer_rows_free(&mimer_stmt->value);
+
+	mimer_stmt->rows_fetched = 0;
+	mimer_stmt->deadline = mimer_stmt->limits.timeout > 0 ?
+		pdo_mimer_hrtime() + (uint64_t) mimer_stmt->limits.timeout * 1000000000 : 0;
+
     if (MimerStatementHasResultSet(mimer_stmt->stmt)) {
 		int column_count;
 		if (!MIMER_SUCCEEDED(column_count = MimerColumnCount(mimer_stmt->stmt)))
@@ -93,7 +215,7 @@ static int pdo_mimer_stmt_executer(pdo_stmt_t *stmt) {
 		php_pdo_stmt_set_column_count(stmt, column_count);
 
 	} else if (!MIMER_SUCCEEDED(MimerExecute(mimer_stmt->stmt))) {
-			goto error;
+		goto error;
 	}
 
 	return true;
@@ -104,6 +226,26 @@ static int pdo_mimer_stmt_executer(pdo_stmt_t *stmt) {
 }
 
 
+/**
+ * @brief Execute a prepared SQL statement.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @return 1 upon success
+ * @return 0 upon failure
+ * @remark Driver is responsible for setting the column_count field in stmt for result set statements.
+ *  @see <a href="https://php-legacy-docs.zend.com/manual/php5/en/internals2.pdo.pdo-stmt-t">
+ *          PDO Driver How-To: pdo_stmt_t definition
+ *      </a>
+ */
+static int pdo_mimer_stmt_executer(pdo_stmt_t *stmt) {
+	uint64_t started = pdo_mimer_stats_start();
+	int success = pdo_mimer_stmt_execute(stmt);
+
+	PDO_MIMER_STATS_INC(executes);
+	PDO_MIMER_STATS_TIME(execute_ns, started);
+	return success;
+}
+
+
 /* lookup table for converting PDO fetch orientation to Mimer SQL fetch operation */
 const int mimer_fetch_op_lut[] = {
 	MIMER_NEXT,
@@ -116,31 +258,43 @@ const int mimer_fetch_op_lut[] = {
 
 
 /**
- * @brief This function will be called by PDO to fetch a row from a previously executed statement object.
- * @param stmt [in] A pointer to the PDOStatement handle object.
- * @param ori [in] One of PDO_FETCH_ORI_xxx which will determine which row will be fetched.
- * @param offset [in] If @p ori is set to PDO_FETCH_ORI_ABS or PDO_FETCH_ORI_REL, offset represents the row desired or the row
- *      relative to the current position, respectively. Otherwise, this value is ignored.
- * @return 1 if data can be fetched
- * @return 0 upon failure or no more data to fetch
- * @remark The results of this fetch are driver dependent and the data is usually stored in the driver_data member of
- * the pdo_stmt_t object. The ori and offset parameters are only meaningful if the statement represents a scrollable
- * cursor.
- * @see <a href="https://php-legacy-docs.zend.com/manual/php5/en/internals2.pdo.implementing">
- *          PDO Driver How-To: Fleshing out your skeleton (SKEL_stmt_fetch)
- *      </a>
+ * @brief Fetches a row, see <code>pdo_mimer_stmt_fetch()</code>.
  */
-static int pdo_mimer_stmt_fetch(pdo_stmt_t *stmt, enum pdo_fetch_orientation ori, zend_long offset) {
+static int pdo_mimer_stmt_fetch_row(pdo_stmt_t *stmt, enum pdo_fetch_orientation ori, zend_long offset) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
-    MimerReturnCode return_code;
+    MimerReturnCode return_code = MIMER_SUCCESS;
+
+	/* only one thread may use the connection at a time, so another statement's prefetch is paused */
+	pdo_mimer_claim_sessions_for(mimer_stmt);
+
+	/* the cap ends the result set early, freeing the cursor on the server */
+	if (mimer_stmt->limits.max_rows > 0 && mimer_stmt->rows_fetched >= mimer_stmt->limits.max_rows) {
+		stmt->row_count = mimer_stmt->rows_fetched;
+		if (!pdo_mimer_cursor_closer(stmt))
+			goto error;
+		return false;
+	}
+
+	/* checked between round-trips only, a single blocking call is not interrupted */
+	if (mimer_stmt->deadline != 0 && pdo_mimer_hrtime() > mimer_stmt->deadline)
+		return pdo_mimer_stmt_timeout(stmt);
 
 	if (!mimer_stmt->cursor.is_open && !pdo_mimer_cursor_opener(stmt))
 		goto error;
 
-    if (mimer_stmt->cursor.is_scrollable)
-        return_code = MimerFetchScroll(mimer_stmt->stmt, mimer_fetch_op_lut[ori], (int32_t) offset);
-    else
-        return_code = MimerFetch(mimer_stmt->stmt);
+	if (mimer_stmt->prefetch.state != NULL) {
+		mimer_stmt->dbh->prefetching = mimer_stmt->prefetch.state;
+		return_code = pdo_mimer_prefetch_next(mimer_stmt->prefetch.state);
+	} else if (mimer_stmt->cursor.is_scrollable)
+		return_code = MimerFetchScroll(mimer_stmt->stmt, mimer_fetch_op_lut[ori], (int32_t) offset);
+	else
+		return_code = MimerFetch(mimer_stmt->stmt);
+
+	if (return_code == PDO_MIMER_OUT_OF_MEMORY) {
+		pdo_mimer_custom_error(stmt, SQLSTATE_MEMORY_ALLOCATION_ERROR, return_code,
+			"Out of memory while prefetching rows");
+		return false;
+	}
 
     if (MIMER_SUCCEEDED(return_code)) {
 		if (return_code == MIMER_NO_DATA) {
@@ -150,6 +304,7 @@ static int pdo_mimer_stmt_fetch(pdo_stmt_t *stmt, enum pdo_fetch_orientation ori
 				return false;
 			}
 		} else {
+			mimer_stmt->rows_fetched++;
 			return true;
 		}
 	}
@@ -160,6 +315,84 @@ static int pdo_mimer_stmt_fetch(pdo_stmt_t *stmt, enum pdo_fetch_orientation ori
 }
 
 
+/**
+ * @brief This function will be called by PDO to fetch a row from a previously executed statement object.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @param ori [in] One of PDO_FETCH_ORI_xxx which will determine which row will be fetched.
+ * @param offset [in] If @p ori is set to PDO_FETCH_ORI_ABS or PDO_FETCH_ORI_REL, offset represents the row desired or the row
+ *      relative to the current position, respectively. Otherwise, this value is ignored.
+ * @return 1 if data can be fetched
+ * @return 0 upon failure or no more data to fetch
+ * @remark The results of this fetch are driver dependent and the data is usually stored in the driver_data member of
+ * the pdo_stmt_t object. The ori and offset parameters are only meaningful if the statement represents a scrollable
+ * cursor.
+ * @see <a href="https://php-legacy-docs.zend.com/manual/php5/en/internals2.pdo.implementing">
+ *          PDO Driver How-To: Fleshing out your skeleton (SKEL_stmt_fetch)
+ *      </a>
+ */
+static int pdo_mimer_stmt_fetch(pdo_stmt_t *stmt, enum pdo_fetch_orientation ori, zend_long offset) {
+	uint64_t started = pdo_mimer_stats_start();
+	int success = pdo_mimer_stmt_fetch_row(stmt, ori, offset);
+
+	PDO_MIMER_STATS_ADD(rows_fetched, success);
+	PDO_MIMER_STATS_TIME(fetch_ns, started);
+	return success;
+}
+
+
+/**
+ * @brief Gets the statement's scratch buffer, for data which is only needed until the next one is requested.
+ * @param mimer_stmt [in] The statement the buffer belongs to.
+ * @param size [in] The number of bytes needed.
+ * @return A buffer of at least @p size bytes, its contents undefined
+ * @remark The buffer grows to the largest size requested and is kept for the following rows, see
+ * <code>PDO_MIMER_SCRATCH_KEEP_SIZE</code> for when it is given back.
+ */
+static char *pdo_mimer_scratch(pdo_mimer_stmt *mimer_stmt, size_t size) {
+	if (size > mimer_stmt->scratch.size) {
+		size_t new_size = MAX(mimer_stmt->scratch.size, PDO_MIMER_SCRATCH_MIN_SIZE);
+		while (new_size < size)
+			new_size *= 2;
+
+		/* nothing is kept in the buffer between requests, so there is nothing to copy */
+		if (mimer_stmt->scratch.buf != NULL)
+			efree(mimer_stmt->scratch.buf);
+		mimer_stmt->scratch.buf = emalloc(new_size);
+		mimer_stmt->scratch.size = new_size;
+	}
+
+	return mimer_stmt->scratch.buf;
+}
+
+
+/**
+ * @brief Looks up a column name among those already seen on the connection.
+ * @param mimer_dbh [in] The connection the statement belongs to.
+ * @param name [in] The column name, as read from the API.
+ * @param len [in] The length of @p name in bytes.
+ * @return A new reference to the connection's string for the name
+ * @remark Statements with the same columns thereby share their names, and as the names' hashes are computed when they
+ * are added to the table, fetching rows as associative arrays does not compute them again.
+ */
+zend_string *pdo_mimer_intern_column_name(pdo_mimer_dbh *mimer_dbh, const char *name, size_t len) {
+	zval *entry, zv;
+
+	if (mimer_dbh->column_names == NULL) {
+		ALLOC_HASHTABLE(mimer_dbh->column_names);
+		zend_hash_init(mimer_dbh->column_names, 32, NULL, ZVAL_PTR_DTOR, false);
+	} else if ((entry = zend_hash_str_find(mimer_dbh->column_names, name, len)) != NULL) {
+		return zend_string_copy(Z_STR_P(entry));
+	} else if (zend_hash_num_elements(mimer_dbh->column_names) >= PDO_MIMER_COLUMN_NAMES_SIZE) {
+		zend_hash_clean(mimer_dbh->column_names);
+	}
+
+	ZVAL_STR(&zv, zend_string_init(name, len, false));
+	zend_hash_add_new(mimer_dbh->column_names, Z_STR(zv), &zv);
+
+	return zend_string_copy(Z_STR(zv));
+}
+
+
 /**
  * @brief This function will be called by PDO to query information about a particular column.
  * @param stmt [in] A pointer to the PDOStatement handle object.
@@ -172,43 +405,57 @@ static int pdo_mimer_describe_col(pdo_stmt_t *stmt, int colno) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
     int16_t mim_colno = colno + 1;
 
-	MimerReturnCode return_code = MimerColumnName8(mimer_stmt->stmt, mim_colno, NULL, 0);
+	char buf[PDO_MIMER_COLUMN_NAME_BUF];
+	zend_string *column_name;
+
+	MimerReturnCode return_code = MimerColumnName8(mimer_stmt->stmt, mim_colno, buf, sizeof(buf));
 	if (!MIMER_SUCCEEDED(return_code)) {
 		pdo_mimer_stmt_error();
 		return false;
 	}
 
-	size_t str_len = return_code + 1;
-	char *column_name = emalloc(str_len);
-	MimerColumnName8(mimer_stmt->stmt, mim_colno, column_name, str_len);
+	if (return_code < (MimerReturnCode) sizeof(buf)) {
+		column_name = pdo_mimer_intern_column_name(mimer_stmt->dbh, buf, return_code);
+	} else {
+		/* too long to be worth interning, read straight into the string handed to PDO */
+		column_name = zend_string_alloc(return_code, false);
+		MimerColumnName8(mimer_stmt->stmt, mim_colno, ZSTR_VAL(column_name), ZSTR_LEN(column_name) + 1);
+	}
 
 	stmt->columns[colno] = (struct pdo_column_data) {
-		.name = zend_string_init(column_name, str_len-1, false), // no null-terminator
+		.name = column_name,
 		.maxlen = SIZE_MAX,
 		.precision = 0,
     };
 
-	efree(column_name);
     return true;
 }
 
 /**
- * @brief This function will be called by PDO to retrieve data from the specified column.
- * @param stmt [in] stmt [in] A pointer to the PDOStatement handle object.
- * @param colno [in] The column number to be queried.
- * @param result [out] Pointer to the retrieved data.
- * @param type [in] Parameter data type.
- * @return 1 upon success
- * @return 0 upon failure
- * @remark PDO is zero-indexed for columns, Mimer SQL's C API is one-indexed.
+ * @brief Gets the value of a column, see <code>pdo_mimer_stmt_get_col_data()</code>.
+ * @param column_type_out [out] The Mimer SQL type of the column, once it is known.
  */
-static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result, enum pdo_param_type *type) {
+static int pdo_mimer_stmt_get_col(pdo_stmt_t *stmt, int colno, zval *result, enum pdo_param_type *type,
+	int32_t *column_type_out) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
     MimerReturnCode return_code;
     int32_t column_type;
+    pdo_mimer_value value;
+    const pdo_mimer_value *prefetched;
+    const char *bytes;
 
     int16_t mim_colno = colno + 1;
 
+    /* decoded by the prefetch thread with the same decoder as below, and converted the same way */
+    if (mimer_stmt->prefetch.state != NULL) {
+        prefetched = pdo_mimer_prefetch_get(mimer_stmt->prefetch.state, colno, &bytes);
+        *column_type_out = pdo_mimer_prefetch_column_type(mimer_stmt->prefetch.state, colno);
+        pdo_mimer_value_zval(prefetched, bytes, &mimer_stmt->strings, colno, result);
+        return true;
+    }
+
+    pdo_mimer_claim_sessions(mimer_stmt->dbh);
+
     column_type = MimerStatementHasResultSet(mimer_stmt->stmt) ?
 		MimerColumnType(mimer_stmt->stmt, mim_colno) : MimerParameterType(mimer_stmt->stmt, mim_colno);
 
@@ -216,6 +463,26 @@ static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result
         pdo_mimer_stmt_error();
         return false;
     }
+    *column_type_out = column_type;
+
+    if (pdo_mimer_value_is_decodable(column_type)) {
+        /* only the value being read is kept in the buffer */
+        pdo_mimer_rows_clear(&mimer_stmt->value);
+        return_code = pdo_mimer_value_decode(&mimer_stmt->value, mimer_stmt->stmt, mim_colno, column_type, &value);
+
+        if (return_code == PDO_MIMER_OUT_OF_MEMORY) {
+            pdo_mimer_custom_error(stmt, SQLSTATE_MEMORY_ALLOCATION_ERROR, return_code, "Out of memory");
+            return false;
+        }
+        if (return_code != MIMER_SUCCESS) {
+            pdo_mimer_stmt_error();
+            return false;
+        }
+
+        bytes = value.kind == PDO_MIMER_VALUE_BYTES ? mimer_stmt->value.data + value.u.offset : NULL;
+        pdo_mimer_value_zval(&value, bytes, &mimer_stmt->strings, colno, result);
+        return true;
+    }
 
     return_code = MimerIsNull(mimer_stmt->stmt, mim_colno);
     if (return_code > 0) {
@@ -227,84 +494,19 @@ static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result
         return false;
     }
 
-    if (MimerIsInt64(column_type)) {
-        int64_t data;
-
-        if (MIMER_SUCCEEDED(return_code = MimerGetInt64(mimer_stmt->stmt, mim_colno, &data))) {
-            ZVAL_LONG(result, data);
-            return true;
-        }
-    }
-
-    else if (MimerIsInt32(column_type)) {
-        int32_t data;
-
-        if (MIMER_SUCCEEDED(return_code = MimerGetInt32(mimer_stmt->stmt, mim_colno, &data))) {
-            ZVAL_LONG(result, data);
-            return true;
-        }
-    }
-
-    else if (MimerIsBinary(column_type)){
-        if (MIMER_SUCCEEDED(return_code = MimerGetBinary(mimer_stmt->stmt, mim_colno, NULL, 0))) {
-            size_t len = return_code + 1;
-            char *data = emalloc(len);
-            data[len-1] = '\0';
-
-            if (MIMER_SUCCEEDED(return_code = MimerGetBinary(mimer_stmt->stmt, mim_colno, data, len)))
-                ZVAL_STRING(result, data);
-
-            efree(data);
-        }
-    }
-
-    else if (MimerIsBoolean(column_type)) {
-        if (MIMER_SUCCEEDED(return_code = MimerGetBoolean(mimer_stmt->stmt, mim_colno))) {
-            ZVAL_BOOL(result, return_code);
-            return true;
-        }
-    }
-
-    else if (MimerIsFloat(column_type)){
-        float data;
-        if (MIMER_SUCCEEDED(return_code = MimerGetFloat(mimer_stmt->stmt, mim_colno, &data))) {
-            ZVAL_DOUBLE(result, data);
-            convert_to_string(result);
-            return true;
-        }
-    }
-
-    else if (MimerIsDouble(column_type)){
-        double data;
-        if (MIMER_SUCCEEDED(return_code = MimerGetDouble(mimer_stmt->stmt, mim_colno, &data))) {
-            ZVAL_DOUBLE(result, data);
-            convert_to_string(result);
-            return true;
-        }
-    }
-
-    else if(MimerIsDecimal(column_type) || MimerIsDatetime(column_type)){
-        /* TODO: Await update to API.
-            Temporary block for handling types which currently gives segfault
-            when checking string length.  */
-#define MIMER_MAX_DECIMAL_CHARS 100
-        char *str = ecalloc(MIMER_MAX_DECIMAL_CHARS, sizeof(char));
-
-        if (MIMER_SUCCEEDED(return_code = MimerGetString8(mimer_stmt->stmt, mim_colno, str, MIMER_MAX_DECIMAL_CHARS)))
-            ZVAL_STRING(result, str);
-		efree(str);
-    }
-
-    else if (MimerIsBlob(column_type)) {
+    if (MimerIsBlob(column_type)) {
         if (!type || *type == PDO_PARAM_STR){ // type is null on fetch where no PARAM_ type has been given
             MimerLob lob_handle;
             size_t lob_len;
             if (MIMER_SUCCEEDED(return_code = MimerGetLob(mimer_stmt->stmt, mim_colno, &lob_len, &lob_handle))){
-                char *buf = emalloc(lob_len+1);
-                return_code = MimerGetBlobData(&lob_handle, buf, lob_len);
-                buf[lob_len] = '\0';
-                ZVAL_STRING(result, buf);
-                efree(buf);
+                zend_string *data = zend_string_alloc(lob_len, false);
+                ZSTR_VAL(data)[lob_len] = '\0';
+
+                if (MIMER_SUCCEEDED(return_code = MimerGetBlobData(&lob_handle, ZSTR_VAL(data), lob_len))) {
+                    ZVAL_NEW_STR(result, data);
+                    PDO_MIMER_STATS_ADD(lob_bytes, lob_len);
+                } else
+                    zend_string_efree(data);
             }
         }
 
@@ -324,10 +526,11 @@ static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result
             MimerLob lob_handle;
             size_t lob_len;
             if (MIMER_SUCCEEDED(return_code = MimerGetLob(mimer_stmt->stmt, mim_colno, &lob_len, &lob_handle))){
-                char *buf = emalloc(lob_len*MIMER_MAX_MB_LEN+1);
+                /* the length is in characters, the bytes are only known once read */
+                char *buf = pdo_mimer_scratch(mimer_stmt, lob_len*MIMER_MAX_MB_LEN+1);
                 return_code = MimerGetNclobData8(&lob_handle, buf, lob_len*MIMER_MAX_MB_LEN+1);
                 ZVAL_STRING(result, buf);
-                efree(buf);
+                PDO_MIMER_STATS_ADD(lob_bytes, Z_STRLEN_P(result));
             }
         }
 
@@ -347,19 +550,6 @@ static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result
         }
     }
 
-    else if (MimerIsString(column_type)){
-        if (MIMER_SUCCEEDED(return_code = MimerGetString8(mimer_stmt->stmt, mim_colno, NULL, 0))) {
-            size_t str_len = return_code + 1; // +1 for null-terminator
-            char *data = emalloc(str_len);
-
-            if (MIMER_SUCCEEDED(return_code = MimerGetString8(mimer_stmt->stmt, mim_colno, data, str_len))) {
-				ZVAL_STRINGL(result, data, str_len-1);
-			}
-
-            efree(data);
-        }
-    }
-
     else {
 //        pdo_mimer_custom_error(stmt, SQLSTATE_GENERAL_ERROR, return_code = PDO_MIMER_UNKNOWN_COLUMN_TYPE,
 //                               "Unknown column type");
@@ -374,6 +564,26 @@ static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result
     return true;
 }
 
+
+/**
+ * @brief This function will be called by PDO to retrieve data from the specified column.
+ * @param stmt [in] stmt [in] A pointer to the PDOStatement handle object.
+ * @param colno [in] The column number to be queried.
+ * @param result [out] Pointer to the retrieved data.
+ * @param type [in] Parameter data type.
+ * @return 1 upon success
+ * @return 0 upon failure
+ * @remark PDO is zero-indexed for columns, Mimer SQL's C API is one-indexed.
+ */
+static int pdo_mimer_stmt_get_col_data(pdo_stmt_t *stmt, int colno, zval *result, enum pdo_param_type *type) {
+	int32_t column_type = 0;
+	int success = pdo_mimer_stmt_get_col(stmt, colno, result, type, &column_type);
+
+	if (PDO_MIMER_STATS_ENABLED() && success)
+		pdo_mimer_stats_cell(column_type, result);
+	return success;
+}
+
 /**
  * @brief Gets the length of the LOB stream, in bytes for all LOB types
  * and in number of characters for CLOBs and NCLOBs.
@@ -427,6 +637,7 @@ static MimerReturnCode pdo_mimer_set_lob_data(pdo_stmt_t *stmt, zval *parameter,
     php_stream *stm = NULL;
     char data_buf[MIMER_LOB_IN_CHUNK];
     ssize_t nread_bytes;
+    size_t nsent_bytes = 0;
 
     /** Try to make a PHP stream from the resource variable */
     if (Z_TYPE_P(parameter) != IS_RESOURCE) {
@@ -461,12 +672,14 @@ static MimerReturnCode pdo_mimer_set_lob_data(pdo_stmt_t *stmt, zval *parameter,
         while(!php_stream_eof(stm) && MIMER_SUCCEEDED(return_code)){
             nread_bytes = php_stream_read(stm, data_buf, MIMER_LOB_IN_CHUNK);
             return_code = MimerSetBlobData(&lob_handle, data_buf, nread_bytes);
+            nsent_bytes += nread_bytes;
         }
 
     } else if (MimerIsClob(lob_type)){
         while(!php_stream_eof(stm) && MIMER_SUCCEEDED(return_code)){
             nread_bytes = php_stream_read(stm, data_buf, MIMER_LOB_IN_CHUNK);
             return_code = MimerSetNclobData8(&lob_handle, data_buf, nread_bytes);
+            nsent_bytes += nread_bytes;
         }
 
     } else if (MimerIsNclob(lob_type)){
@@ -489,9 +702,12 @@ static MimerReturnCode pdo_mimer_set_lob_data(pdo_stmt_t *stmt, zval *parameter,
                 break;
             }
             return_code = MimerSetNclobData8(&lob_handle, data_buf, nvalid_bytes);
+            nsent_bytes += nvalid_bytes;
         }
     }
 
+    PDO_MIMER_STATS_ADD(bytes_out, nsent_bytes);
+    PDO_MIMER_STATS_ADD(lob_bytes, nsent_bytes);
     return return_code;
 }
 
@@ -542,9 +758,10 @@ static MimerReturnCode pdo_mimer_stmt_set_params(pdo_stmt_t *stmt, zval *paramet
         return_code = MimerSetDouble(mimer_stmt->stmt, paramno, val);
     }
     else if (MimerIsBinary(mim_type)) {
-        zend_string *str = zval_get_string(parameter);
+        zend_string *tmp_str, *str = zval_get_tmp_string(parameter, &tmp_str);
         return_code = MimerSetBinary(mimer_stmt->stmt, paramno, ZSTR_VAL(str), ZSTR_LEN(str));
-        zend_string_release(str);
+        PDO_MIMER_STATS_ADD(bytes_out, ZSTR_LEN(str));
+        zend_tmp_string_release(tmp_str);
     }
     else if (MimerIsBlob(mim_type) || MimerIsClob(mim_type) || MimerIsNclob(mim_type)) {
 
@@ -552,7 +769,7 @@ static MimerReturnCode pdo_mimer_stmt_set_params(pdo_stmt_t *stmt, zval *paramet
             return_code = pdo_mimer_set_lob_data(stmt, parameter, paramno);
 
         else {
-            zend_string *str = zval_get_string(parameter);
+            zend_string *tmp_str, *str = zval_get_tmp_string(parameter, &tmp_str);
             size_t lob_len = ZSTR_LEN(str);
             MimerLob lob_handle;
             if (MIMER_SUCCEEDED(return_code = MimerSetLob(mimer_stmt->stmt, paramno, lob_len, &lob_handle))){
@@ -560,14 +777,17 @@ static MimerReturnCode pdo_mimer_stmt_set_params(pdo_stmt_t *stmt, zval *paramet
                     return_code = MimerSetBlobData(&lob_handle, ZSTR_VAL(str), lob_len);
                 else
                     return_code = MimerSetNclobData8(&lob_handle, ZSTR_VAL(str), lob_len);
+                PDO_MIMER_STATS_ADD(bytes_out, lob_len);
+                PDO_MIMER_STATS_ADD(lob_bytes, lob_len);
             }
-            zend_string_release(str);
+            zend_tmp_string_release(tmp_str);
         }
     }
     else if (MimerIsString(mim_type)){
-        zend_string *str = zval_get_string(parameter);
-        return_code = MimerSetString8(mimer_stmt->stmt, paramno, ZSTR_VAL(str));
-        zend_string_release(str);
+        zend_string *tmp_str, *str = zval_get_tmp_string(parameter, &tmp_str);
+        return_code = pdo_mimer_set_string8(mimer_stmt->stmt, paramno, ZSTR_VAL(str), ZSTR_LEN(str));
+        PDO_MIMER_STATS_ADD(bytes_out, ZSTR_LEN(str));
+        zend_tmp_string_release(tmp_str);
     }
 //    else
 //        pdo_mimer_custom_error(stmt, SQLSTATE_GENERAL_ERROR, return_code = PDO_MIMER_GENERAL_ERROR,
@@ -577,6 +797,20 @@ static MimerReturnCode pdo_mimer_stmt_set_params(pdo_stmt_t *stmt, zval *paramet
 }
 
 
+/**
+ * @brief Reports a parameter which could not be set, see <code>pdo_mimer_stmt_set_params()</code>.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @param return_code [in] The code returned when setting it.
+ */
+static void pdo_mimer_param_error(pdo_stmt_t *stmt, MimerReturnCode return_code) {
+	if (return_code == PDO_MIMER_EMBEDDED_NUL)
+		pdo_mimer_custom_error(stmt, SQLSTATE_INVALID_PARAMETER_VALUE, return_code,
+			"String parameter contains a NUL character");
+	else
+		pdo_mimer_stmt_error();
+}
+
+
 static int skip_param_event(enum pdo_param_event event_type) {
 	switch (event_type) {
 		case PDO_PARAM_EVT_FETCH_POST:
@@ -609,6 +843,14 @@ static int pdo_mimer_stmt_param_hook(pdo_stmt_t *stmt, struct pdo_bound_param_da
 	if (skip_param_event(event_type))
 		return true;
 
+	pdo_mimer_claim_sessions(mimer_stmt->dbh);
+
+	/* once an array is bound, all parameters are set by the executer, see pdo_mimer_bind_arrays() */
+	if (param->is_param && PDO_PARAM_TYPE(param->param_type) == MIMER_PARAM_ARRAY)
+		mimer_stmt->arrays.is_bound = true;
+	if (mimer_stmt->arrays.is_bound && event_type != PDO_PARAM_EVT_EXEC_POST)
+		return true;
+
     if (mimer_stmt->stmt == NULL || !param->is_param) { /* if not param, is of column type */
         return 1;
     }
@@ -663,7 +905,7 @@ static int pdo_mimer_stmt_param_hook(pdo_stmt_t *stmt, struct pdo_bound_param_da
     }
 
     if (!MIMER_SUCCEEDED(return_code)) {
-        pdo_mimer_stmt_error();
+        pdo_mimer_param_error(stmt, return_code);
         return false;
     }
 
@@ -671,6 +913,188 @@ static int pdo_mimer_stmt_param_hook(pdo_stmt_t *stmt, struct pdo_bound_param_da
 }
 
 
+/**
+ * @brief Records where the placeholders are in the statement's SQL, skipping literals and comments.
+ * @param mimer_stmt [in] The PDO Mimer statement.
+ */
+static void pdo_mimer_find_placeholders(pdo_mimer_stmt *mimer_stmt) {
+	const char *sql = ZSTR_VAL(mimer_stmt->sql), *p = sql, *end = sql + ZSTR_LEN(mimer_stmt->sql);
+	uint32_t count = 0, size = 8;
+	uint32_t *offsets = emalloc(size * sizeof(uint32_t));
+
+	while (p < end) {
+		const char *next = pdo_mimer_sql_skip(p, end);
+		if (next != p) {
+			p = next;
+			continue;
+		}
+
+		if (*p == '?') {
+			if (count == size)
+				offsets = erealloc(offsets, (size *= 2) * sizeof(uint32_t));
+			offsets[count++] = p - sql;
+		}
+		p++;
+	}
+
+	mimer_stmt->arrays.placeholders = offsets;
+	mimer_stmt->arrays.num_placeholders = count;
+	mimer_stmt->arrays.shape = emalloc(count + 1);
+}
+
+
+/**
+ * @brief Builds the SQL of the current shape, with each array placeholder repeated as many times as the shape says.
+ * @param mimer_stmt [in] The PDO Mimer statement.
+ * @return The expanded SQL.
+ */
+static zend_string *pdo_mimer_expand_placeholders(pdo_mimer_stmt *mimer_stmt) {
+	const char *sql = ZSTR_VAL(mimer_stmt->sql);
+	smart_str expanded = {0};
+	size_t from = 0;
+
+	for (uint32_t i = 0; i < mimer_stmt->arrays.num_placeholders; i++) {
+		size_t to = mimer_stmt->arrays.placeholders[i] + 1;
+
+		smart_str_appendl(&expanded, sql + from, to - from);
+		for (uint32_t j = 1; j < (1U << mimer_stmt->arrays.shape[i]); j++)
+			smart_str_appendl(&expanded, ", ?", sizeof(", ?") - 1);
+		from = to;
+	}
+
+	smart_str_appendl(&expanded, sql + from, ZSTR_LEN(mimer_stmt->sql) - from);
+	smart_str_0(&expanded);
+	return expanded.s;
+}
+
+
+/**
+ * @brief Maps the position of a placeholder in the original SQL to the number of its first Mimer parameter in the
+ * current shape.
+ */
+static int32_t pdo_mimer_array_paramno(pdo_mimer_stmt *mimer_stmt, zend_long position) {
+	int32_t paramno = position + 1;
+
+	for (zend_long i = 0; i < position; i++)
+		paramno += (1 << mimer_stmt->arrays.shape[i]) - 1;
+
+	return paramno;
+}
+
+
+/**
+ * @brief Switches to the statement shaped for the arrays currently bound with <code>PDO::MIMER_PARAM_ARRAY</code>,
+ * preparing it on first use, and sets all parameters on it.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @return true upon success
+ * @return false upon failure
+ * @remark An array placeholder is expanded to the next power of two of the number of elements, the extra ones
+ * repeating the last element (NULL for an empty array). An <code>IN</code> list thus gets the same result while only
+ * log2(N) shapes of the statement are ever compiled, and they are kept for the life of the statement.
+ */
+static bool pdo_mimer_bind_arrays(pdo_stmt_t *stmt) {
+	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+	struct pdo_bound_param_data *param;
+	MimerStatement statement;
+	MimerReturnCode return_code = MIMER_SUCCESS;
+
+	if (mimer_stmt->arrays.placeholders == NULL)
+		pdo_mimer_find_placeholders(mimer_stmt);
+
+	unsigned char *shape = mimer_stmt->arrays.shape;
+	uint32_t num_placeholders = mimer_stmt->arrays.num_placeholders;
+	memset(shape, 0, num_placeholders);
+
+	ZEND_HASH_FOREACH_PTR(stmt->bound_params, param) {
+		zval *value = Z_ISREF(param->parameter) ? Z_REFVAL(param->parameter) : &param->parameter;
+
+		if (PDO_PARAM_TYPE(param->param_type) != MIMER_PARAM_ARRAY || Z_TYPE_P(value) != IS_ARRAY ||
+			param->paramno < 0 || param->paramno >= num_placeholders)
+			continue;
+
+		while ((1U << shape[param->paramno]) < zend_hash_num_elements(Z_ARRVAL_P(value)))
+			shape[param->paramno]++;
+	} ZEND_HASH_FOREACH_END();
+
+	/* Mimer SQL numbers parameters with a 16-bit integer */
+	if (pdo_mimer_array_paramno(mimer_stmt, num_placeholders) - 1 > INT16_MAX) {
+		pdo_raise_impl_error(stmt->dbh, stmt, SQLSTATE_GENERAL_ERROR, "arrays bound expand to too many parameters");
+		return false;
+	}
+
+	if (mimer_stmt->arrays.statements == NULL) {
+		ALLOC_HASHTABLE(mimer_stmt->arrays.statements);
+		zend_hash_init(mimer_stmt->arrays.statements, 8, NULL, NULL, false);
+	}
+
+	/* the shape where every array has at most one element is the statement as prepared on its session */
+	bool is_flat = true;
+	for (uint32_t i = 0; i < num_placeholders; i++)
+		is_flat = is_flat && shape[i] == 0;
+	shape[num_placeholders] = mimer_stmt->is_on_read_session;
+
+	if (is_flat)
+		statement = mimer_stmt->is_on_read_session ? mimer_stmt->routes.read : mimer_stmt->routes.primary;
+	else
+		statement = zend_hash_str_find_ptr(mimer_stmt->arrays.statements, (char *) shape, num_placeholders + 1);
+
+	if (statement == NULL) {
+		MimerSession session = pdo_mimer_stmt_session(mimer_stmt);
+		zend_string *sql = pdo_mimer_expand_placeholders(mimer_stmt);
+
+		return_code = MimerBeginStatement8(session, ZSTR_VAL(sql),
+			mimer_stmt->cursor.is_scrollable ? MIMER_SCROLLABLE : MIMER_FORWARD_ONLY, &statement);
+		zend_string_release(sql);
+		PDO_MIMER_STATS_INC(prepares);
+
+		if (!MIMER_SUCCEEDED(return_code)) {
+			pdo_mimer_error_from(stmt->dbh, stmt, (MimerHandle) session, __FILE__, __LINE__);
+			return false;
+		}
+
+		zend_hash_str_add_ptr(mimer_stmt->arrays.statements, (char *) shape, num_placeholders + 1, statement);
+	} else
+		PDO_MIMER_STATS_INC(stmt_cache_hits);
+
+	mimer_stmt->stmt = statement;
+
+	ZEND_HASH_FOREACH_PTR(stmt->bound_params, param) {
+		zval *value = Z_ISREF(param->parameter) ? Z_REFVAL(param->parameter) : &param->parameter;
+
+		if (param->paramno < 0 || param->paramno >= num_placeholders)
+			continue;
+
+		int32_t paramno = pdo_mimer_array_paramno(mimer_stmt, param->paramno);
+
+		if (PDO_PARAM_TYPE(param->param_type) == MIMER_PARAM_ARRAY && Z_TYPE_P(value) == IS_ARRAY) {
+			uint32_t width = 1U << shape[param->paramno], i = 0;
+			zval *element, padding;
+
+			ZVAL_NULL(&padding);
+			ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value), element) {
+				if (!MIMER_SUCCEEDED(return_code = pdo_mimer_stmt_set_params(stmt, element, paramno + i++,
+					PDO_PARAM_STR)))
+					break;
+				ZVAL_COPY_VALUE(&padding, element);
+			} ZEND_HASH_FOREACH_END();
+
+			while (MIMER_SUCCEEDED(return_code) && i < width)
+				return_code = pdo_mimer_stmt_set_params(stmt, &padding, paramno + i++, PDO_PARAM_STR);
+		} else {
+			return_code = pdo_mimer_stmt_set_params(stmt, value, paramno, PDO_PARAM_TYPE(param->param_type) ==
+				MIMER_PARAM_ARRAY ? PDO_PARAM_STR : param->param_type);
+		}
+
+		if (!MIMER_SUCCEEDED(return_code)) {
+			pdo_mimer_param_error(stmt, return_code);
+			return false;
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	return true;
+}
+
+
 /**
  * @brief The function PDO calls to close the current cursor.
  * @param stmt [in] A pointer to the PDOStatement handle object.
@@ -680,6 +1104,15 @@ static int pdo_mimer_stmt_param_hook(pdo_stmt_t *stmt, struct pdo_bound_param_da
 static int pdo_mimer_cursor_closer(pdo_stmt_t *stmt) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
 
+	if (mimer_stmt->prefetch.state != NULL) {
+		if (mimer_stmt->dbh->prefetching == mimer_stmt->prefetch.state)
+			mimer_stmt->dbh->prefetching = NULL;
+		pdo_mimer_prefetch_stop(mimer_stmt->prefetch.state);
+		mimer_stmt->prefetch.state = NULL;
+	}
+
+	pdo_mimer_claim_sessions(mimer_stmt->dbh);
+
 	switch (MimerCloseCursor(mimer_stmt->stmt)) {
 		case MIMER_SUCCESS:
 		case MIMER_SEQUENCE_ERROR:
@@ -692,6 +1125,24 @@ static int pdo_mimer_cursor_closer(pdo_stmt_t *stmt) {
 }
 
 
+/**
+ * @brief The function PDO calls to advance a statement to its next result set.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @return 0, as there is no next result set or upon failure
+ * @remark A Mimer SQL statement, result set procedures included, yields at most one result set. The current one is
+ * closed and PDO drops its columns, so <code>nextRowset()</code> ends the result set like it does for drivers with
+ * several.
+ */
+static int pdo_mimer_stmt_next_rowset(pdo_stmt_t *stmt) {
+	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+
+	if (mimer_stmt->cursor.is_open && !pdo_mimer_cursor_closer(stmt))
+		pdo_mimer_stmt_error();
+
+	return false;
+}
+
+
 /**
  * @brief The function PDO calls to open a cursor on a statement.
  * @param stmt [in] A pointer to the PDOStatement handle object.
@@ -701,10 +1152,21 @@ static int pdo_mimer_cursor_closer(pdo_stmt_t *stmt) {
 static int pdo_mimer_cursor_opener(pdo_stmt_t *stmt) {
 	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
 
+	pdo_mimer_claim_sessions_for(mimer_stmt);
+
+	if (mimer_stmt->limits.fetch_size > 0 &&
+		!MIMER_SUCCEEDED(MimerSetArraySize(mimer_stmt->stmt, mimer_stmt->limits.fetch_size)))
+		return false;
+
 	switch (MimerOpenCursor(mimer_stmt->stmt)) {
 		case MIMER_SUCCESS:
 		case MIMER_SEQUENCE_ERROR:
 			mimer_stmt->cursor.is_open = true;
+
+			/* a scrollable cursor is moved by the caller, so only forward-only ones are fetched ahead */
+			if (mimer_stmt->prefetch.rows > 0 && !mimer_stmt->cursor.is_scrollable && stmt->column_count > 0)
+				mimer_stmt->prefetch.state = pdo_mimer_prefetch_start(mimer_stmt->stmt, stmt->column_count,
+					mimer_stmt->prefetch.rows);
 			return true;
 
 		default:
@@ -833,6 +1295,8 @@ static int pdo_mimer_get_column_meta(pdo_stmt_t *stmt, zend_long colno, zval *re
     const char *native_type;
     zval flags;
 
+    pdo_mimer_claim_sessions(mimer_stmt->dbh);
+
     mimcolno = colno + 1;
     if (!MIMER_SUCCEEDED(col_type = MimerColumnType(mimer_stmt->stmt, mimcolno))) {
         pdo_mimer_stmt_error();
@@ -871,6 +1335,114 @@ static int pdo_mimer_get_column_meta(pdo_stmt_t *stmt, zend_long colno, zval *re
 }
 
 
+/**
+ * @brief PDO Mimer method to set statement attributes.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @param attribute [in] The Mimer SQL statement attribute to set.
+ * @param value [in] The value to set for the given attribute.
+ * @return 1 upon success
+ * @return 0 if the value is invalid or the attribute not supported
+ * @remark The attributes take effect at the next <code>execute()</code>.
+ */
+static int pdo_mimer_stmt_set_attribute(pdo_stmt_t *stmt, zend_long attribute, zval *value) {
+	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+	zend_long lval;
+
+	switch (attribute) {
+		case MIMER_ATTR_TRIM_CHAR: {
+			bool trim;
+			if (!pdo_get_bool_param(&trim, value))
+				return false;
+
+			mimer_stmt->strings.is_char_trimmed = trim;
+			return true;
+		}
+
+		case MIMER_ATTR_DEDUP_STRINGS: {
+			bool dedup;
+			if (!pdo_get_bool_param(&dedup, value))
+				return false;
+
+			if (!dedup)
+				pdo_mimer_strings_free(&mimer_stmt->strings);
+			mimer_stmt->strings.is_deduped = dedup;
+			return true;
+		}
+
+		case MIMER_ATTR_FETCH_SIZE:
+		case MIMER_ATTR_MAX_ROWS:
+		case MIMER_ATTR_QUERY_TIMEOUT:
+		case MIMER_ATTR_PREFETCH_ROWS:
+			if (!pdo_get_long_param(&lval, value))
+				return false;
+			break;
+
+		default:
+			pdo_mimer_custom_error(stmt, SQLSTATE_DRIVER_DOES_NOT_SUPPORT_FUNCTION, PDO_MIMER_UNSUPPORTED_ATTRIBUTE,
+								   "driver doesn't support setting that attribute");
+			return false;
+	}
+
+	if (lval < 0) {
+		zend_value_error("Attribute value must be greater than or equal to 0");
+		return false;
+	}
+
+	switch (attribute) {
+		case MIMER_ATTR_FETCH_SIZE:
+			mimer_stmt->limits.fetch_size = (int32_t) MIN(lval, INT32_MAX);
+			break;
+		case MIMER_ATTR_MAX_ROWS:
+			mimer_stmt->limits.max_rows = lval;
+			break;
+		case MIMER_ATTR_QUERY_TIMEOUT:
+			mimer_stmt->limits.timeout = lval;
+			break;
+		case MIMER_ATTR_PREFETCH_ROWS:
+			mimer_stmt->prefetch.rows = lval;
+			break;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief PDO Mimer method to get statement attributes.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @param attribute [in] The Mimer SQL statement attribute to get.
+ * @param return_value [out] The value of the attribute.
+ * @return 1 upon success
+ * @return 0 if the attribute is not supported
+ */
+static int pdo_mimer_stmt_get_attribute(pdo_stmt_t *stmt, zend_long attribute, zval *return_value) {
+	pdo_mimer_stmt *mimer_stmt = stmt->driver_data;
+
+	switch (attribute) {
+		case MIMER_ATTR_FETCH_SIZE:
+			ZVAL_LONG(return_value, mimer_stmt->limits.fetch_size);
+			return true;
+		case MIMER_ATTR_MAX_ROWS:
+			ZVAL_LONG(return_value, mimer_stmt->limits.max_rows);
+			return true;
+		case MIMER_ATTR_QUERY_TIMEOUT:
+			ZVAL_LONG(return_value, mimer_stmt->limits.timeout);
+			return true;
+		case MIMER_ATTR_DEDUP_STRINGS:
+			ZVAL_BOOL(return_value, mimer_stmt->strings.is_deduped);
+			return true;
+		case MIMER_ATTR_TRIM_CHAR:
+			ZVAL_BOOL(return_value, mimer_stmt->strings.is_char_trimmed);
+			return true;
+		case MIMER_ATTR_PREFETCH_ROWS:
+			ZVAL_LONG(return_value, mimer_stmt->prefetch.rows);
+			return true;
+		default:
+			return false;
+	}
+}
+
+
 /**
  * @brief The PHP method <code>mimerAddBatch()</code> extends the <code>PDOStatement</code> class to be able to set
  * multiple parameter values on a prepared statement with Mimer SQL.
@@ -890,6 +1462,152 @@ PHP_METHOD(PDOStatement_MimerSQL_Ext, mimerAddBatch) {
 }
 
 
+/**
+ * @brief Decodes the current row into an array.
+ * @param stmt [in] A pointer to the PDOStatement handle object.
+ * @param row [in|out] An empty array, filled with the row's values.
+ * @param mode [in] PDO::FETCH_ASSOC or PDO::FETCH_NUM.
+ * @return true upon success
+ * @return false upon failure
+ */
+static bool pdo_mimer_each_row(pdo_stmt_t *stmt, HashTable *row, zend_long mode) {
+	for (int colno = 0; colno < stmt->column_count; colno++) {
+		zval value;
+
+		ZVAL_NULL(&value);
+		if (!pdo_mimer_stmt_get_col_data(stmt, colno, &value, NULL)) {
+			zval_ptr_dtor(&value);
+			return false;
+		}
+
+		if (mode == PDO_FETCH_ASSOC)
+			zend_symtable_update(row, stmt->columns[colno].name, &value);
+		else
+			zend_hash_next_index_insert_new(row, &value);
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Calls the callback of <code>mimerEach()</code>.
+ * @param fci [in] The callback.
+ * @param fcc [in] The callback's cache.
+ * @param arg [in] The row or batch of rows to pass.
+ * @return true if iteration should go on
+ * @return false if the callback returned false or threw
+ */
+static bool pdo_mimer_each_call(zend_fcall_info *fci, zend_fcall_info_cache *fcc, zval *arg) {
+	zval retval;
+	bool go_on;
+
+	ZVAL_UNDEF(&retval);
+	fci->params = arg;
+	fci->param_count = 1;
+	fci->retval = &retval;
+
+	go_on = zend_call_function(fci, fcc) == SUCCESS && !EG(exception) && Z_TYPE(retval) != IS_FALSE;
+	zval_ptr_dtor(&retval);
+	return go_on;
+}
+
+
+/**
+ * @brief The PHP method <code>mimerEach()</code> passes each row of an executed statement's result set to a callback.
+ * @param callback [in] Called with each row, or with an array of up to @p batch rows.
+ * @param mode [in] PDO::FETCH_ASSOC or PDO::FETCH_NUM.
+ * @param batch [in] The number of rows per call, 1 passes the row itself.
+ * @param return_value [out] The number of rows passed, or false upon failure.
+ * @remark Rows are fetched and decoded in the driver without going through PDO's fetch, so PDO::ATTR_STRINGIFY_FETCHES,
+ * PDO::ATTR_ORACLE_NULLS and bound columns do not apply. When the callback does not keep a row, its array is reused
+ * for the next one. Iteration stops when the callback returns false or throws, and the cursor is closed.
+ */
+PHP_METHOD(PDOStatement_MimerSQL_Ext, mimerEach) {
+	pdo_stmt_t *stmt = Z_PDO_STMT_P(ZEND_THIS);
+	zend_fcall_info fci;
+	zend_fcall_info_cache fcc;
+	zend_long mode = PDO_FETCH_ASSOC, batch = 1, count = 0;
+	zval row, rows;
+	bool go_on = true;
+
+	ZEND_PARSE_PARAMETERS_START(1, 3)
+		Z_PARAM_FUNC(fci, fcc)
+		Z_PARAM_OPTIONAL
+		Z_PARAM_LONG(mode)
+		Z_PARAM_LONG(batch)
+	ZEND_PARSE_PARAMETERS_END();
+
+	if (mode != PDO_FETCH_ASSOC && mode != PDO_FETCH_NUM) {
+		zend_argument_value_error(2, "must be either PDO::FETCH_ASSOC or PDO::FETCH_NUM");
+		RETURN_THROWS();
+	}
+	if (batch < 1) {
+		zend_argument_value_error(3, "must be greater than 0");
+		RETURN_THROWS();
+	}
+
+	strcpy(stmt->error_code, PDO_ERR_NONE);
+	if (!stmt->executed || stmt->column_count == 0) {
+		pdo_raise_impl_error(stmt->dbh, stmt, "HY010", "the statement has no result set to iterate");
+		RETURN_FALSE;
+	}
+
+	ZVAL_UNDEF(&row);
+	if (batch > 1)
+		array_init_size(&rows, (uint32_t) MIN(batch, 1024));
+
+	while (go_on && pdo_mimer_stmt_fetch(stmt, PDO_FETCH_ORI_NEXT, 0)) {
+		/* reuse the previous row's array, unless the callback kept it */
+		if (Z_TYPE(row) == IS_ARRAY && Z_REFCOUNT(row) == 1) {
+			zend_hash_clean(Z_ARRVAL(row));
+		} else {
+			zval_ptr_dtor(&row);
+			array_init_size(&row, stmt->column_count);
+		}
+
+		if (!pdo_mimer_each_row(stmt, Z_ARRVAL(row), mode))
+			break;
+		count++;
+
+		if (batch == 1) {
+			go_on = pdo_mimer_each_call(&fci, &fcc, &row);
+			continue;
+		}
+
+		/* the batch owns its rows, a new array is made for the next one */
+		add_next_index_zval(&rows, &row);
+		ZVAL_UNDEF(&row);
+
+		if (zend_hash_num_elements(Z_ARRVAL(rows)) == (uint32_t) batch) {
+			go_on = pdo_mimer_each_call(&fci, &fcc, &rows);
+			zval_ptr_dtor(&rows);
+			array_init_size(&rows, (uint32_t) MIN(batch, 1024));
+		}
+	}
+
+	bool has_failed = strcmp(stmt->error_code, PDO_ERR_NONE) != 0;
+	if (batch > 1 && go_on && !has_failed && zend_hash_num_elements(Z_ARRVAL(rows)) > 0)
+		pdo_mimer_each_call(&fci, &fcc, &rows);
+
+	zval_ptr_dtor(&row);
+	if (batch > 1)
+		zval_ptr_dtor(&rows);
+
+	pdo_mimer_cursor_closer(stmt);
+
+	if (EG(exception))
+		RETURN_THROWS();
+
+	if (has_failed) {
+		pdo_handle_error(stmt->dbh, stmt);
+		RETURN_FALSE;
+	}
+
+	RETURN_LONG(count);
+}
+
+
 /* the methods implemented by PDO Mimer to interface with PDOStatement */
 const struct pdo_stmt_methods pdo_mimer_stmt_methods = {
         pdo_mimer_stmt_dtor,   /* statement destructor method */
@@ -898,9 +1616,9 @@ const struct pdo_stmt_methods pdo_mimer_stmt_methods = {
         pdo_mimer_describe_col,   /* statement describer method */
         pdo_mimer_stmt_get_col_data,   /* statement get column method */
         pdo_mimer_stmt_param_hook,   /* statement parameter hook method */
-        NULL,   /* statement set attribute method */
-        NULL,   /* statement get attribute method */
+        pdo_mimer_stmt_set_attribute,   /* statement set attribute method */
+        pdo_mimer_stmt_get_attribute,   /* statement get attribute method */
         pdo_mimer_get_column_meta,   /* statement get column data method */
-        NULL,   /* next statement rowset method */
+        pdo_mimer_stmt_next_rowset,   /* next statement rowset method */
         pdo_mimer_cursor_closer,   /* statement cursor closer method */
 };
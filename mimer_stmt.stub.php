@@ -7,5 +7,8 @@ class PDOStatement_MimerSQL_Ext {
 
     /** @tentative-return-type */
     public function mimerAddBatch(): bool {}
+
+    /** @tentative-return-type */
+    public function mimerEach(callable $callback, int $mode = PDO::FETCH_ASSOC, int $batch = 1): int|false {}
 }
 
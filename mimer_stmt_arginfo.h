@@ -1,14 +1,22 @@
 /* This is a generated file, edit the .stub.php file instead.
- * Stub hash: 74a48712220127d8ddef2d9d7d9991ab1d4777d0 */
+ * Stub hash: cc395731d2cf63b8e4b26d1bf3ffc5e32a176929 */
 
 ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_INFO_EX(arginfo_class_PDOStatement_MimerSQL_Ext_mimerAddBatch, 0, 0, _IS_BOOL, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_TENTATIVE_RETURN_TYPE_MASK_EX(arginfo_class_PDOStatement_MimerSQL_Ext_mimerEach, 0, 1, MAY_BE_LONG|MAY_BE_FALSE)
+	ZEND_ARG_TYPE_INFO(0, callback, IS_CALLABLE, 0)
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, mode, IS_LONG, 0, "PDO::FETCH_ASSOC")
+	ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, batch, IS_LONG, 0, "1")
+ZEND_END_ARG_INFO()
+
 
 ZEND_METHOD(PDOStatement_MimerSQL_Ext, mimerAddBatch);
+ZEND_METHOD(PDOStatement_MimerSQL_Ext, mimerEach);
 
 
 static const zend_function_entry class_PDOStatement_MimerSQL_Ext_methods[] = {
 	ZEND_ME(PDOStatement_MimerSQL_Ext, mimerAddBatch, arginfo_class_PDOStatement_MimerSQL_Ext_mimerAddBatch, ZEND_ACC_PUBLIC)
+	ZEND_ME(PDOStatement_MimerSQL_Ext, mimerEach, arginfo_class_PDOStatement_MimerSQL_Ext_mimerEach, ZEND_ACC_PUBLIC)
 	ZEND_FE_END
 };
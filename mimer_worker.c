@@ -0,0 +1,391 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "pdo/php_pdo.h"
+#include "pdo/php_pdo_driver.h"
+#include "php_pdo_mimer.h"
+#include "php_pdo_mimer_int.h"
+
+/*
+ * Helpers shared by the features running statements on worker threads, each with a session of its own: values are
+ * converted and errors reported on the PHP thread, the worker threads only see plain malloc() memory.
+ */
+
+
+/**
+ * @brief Copies a string into plain malloc() memory, for a worker thread.
+ * @return The copy, or NULL if @p str is NULL or out of memory.
+ */
+char *pdo_mimer_worker_strdup(const char *str, size_t len) {
+	char *copy = str != NULL ? malloc(len + 1) : NULL;
+
+	if (copy != NULL) {
+		memcpy(copy, str, len);
+		copy[len] = '\0';
+	}
+
+	return copy;
+}
+
+
+/**
+ * @brief Converts a parameter value on the PHP thread, to each type the parameter may have.
+ * @return true upon success
+ * @return false if the value is not a scalar or null, or out of memory
+ */
+bool pdo_mimer_worker_param_init(pdo_mimer_worker_param *param, zval *value) {
+	ZVAL_DEREF(value);
+
+	switch (Z_TYPE_P(value)) {
+		case IS_NULL:
+			param->is_null = true;
+			return true;
+
+		case IS_FALSE:
+		case IS_TRUE:
+		case IS_LONG:
+		case IS_DOUBLE:
+		case IS_STRING: {
+			zend_string *tmp_str, *str = zval_get_tmp_string(value, &tmp_str);
+
+			param->bval = zend_is_true(value);
+			param->lval = zval_get_long(value);
+			param->dval = zval_get_double(value);
+			param->len = ZSTR_LEN(str);
+			param->str = pdo_mimer_worker_strdup(ZSTR_VAL(str), ZSTR_LEN(str));
+
+			zend_tmp_string_release(tmp_str);
+			return param->str != NULL;
+		}
+
+		default:
+			return false;
+	}
+}
+
+
+void pdo_mimer_worker_param_free(pdo_mimer_worker_param *param) {
+	free(param->str);
+	param->str = NULL;
+}
+
+
+/**
+ * @brief Sets a parameter of a statement, picking the conversion matching the parameter's type like
+ * <code>pdo_mimer_stmt_set_params()</code> does with a zval.
+ * @remark Worker thread.
+ */
+MimerReturnCode pdo_mimer_worker_param_set(const pdo_mimer_worker_param *param, MimerStatement statement,
+	int16_t paramno) {
+	MimerReturnCode return_code;
+	MimerLob lob_handle;
+
+	if (!MIMER_SUCCEEDED(return_code = MimerParameterMode(statement, paramno)))
+		return return_code;
+
+	if (return_code == MIMER_PARAM_OUTPUT)
+		return MIMER_SUCCESS;
+
+	if (param->is_null)
+		return MimerSetNull(statement, paramno);
+
+	if (!MIMER_SUCCEEDED(return_code = MimerParameterType(statement, paramno)))
+		return return_code;
+
+	int32_t param_type = return_code;
+
+	if (MimerIsInt32(param_type))
+		return MimerSetInt32(statement, paramno, (int32_t) param->lval);
+	if (MimerIsInt64(param_type))
+		return MimerSetInt64(statement, paramno, param->lval);
+	if (MimerIsBoolean(param_type))
+		return MimerSetBoolean(statement, paramno, param->bval);
+	if (MimerIsFloat(param_type))
+		return MimerSetFloat(statement, paramno, (float) param->dval);
+	if (MimerIsDouble(param_type))
+		return MimerSetDouble(statement, paramno, param->dval);
+	if (MimerIsBinary(param_type))
+		return MimerSetBinary(statement, paramno, param->str, param->len);
+
+	if (MimerIsBlob(param_type) || MimerIsClob(param_type) || MimerIsNclob(param_type)) {
+		if (!MIMER_SUCCEEDED(return_code = MimerSetLob(statement, paramno, param->len, &lob_handle)))
+			return return_code;
+
+		return MimerIsBlob(param_type) ? MimerSetBlobData(&lob_handle, param->str, param->len) :
+			MimerSetNclobData8(&lob_handle, param->str, param->len);
+	}
+
+	return pdo_mimer_set_string8(statement, paramno, param->str, param->len);
+}
+
+
+/**
+ * @brief Reads the names of a result set's columns.
+ * @param names [out] The names, malloc()'ed, to free with <code>pdo_mimer_worker_column_names_free()</code>.
+ * @return MIMER_SUCCESS, PDO_MIMER_OUT_OF_MEMORY, or the API's error
+ * @remark Worker thread.
+ */
+MimerReturnCode pdo_mimer_worker_column_names(MimerStatement statement, int num_columns, char ***names) {
+	MimerReturnCode return_code;
+
+	if ((*names = calloc(num_columns, sizeof(char *))) == NULL)
+		return PDO_MIMER_OUT_OF_MEMORY;
+
+	for (int16_t colno = 1; colno <= num_columns; colno++) {
+		if (!MIMER_SUCCEEDED(return_code = MimerColumnName8(statement, colno, NULL, 0)))
+			return return_code;
+		if (((*names)[colno - 1] = malloc(return_code + 1)) == NULL)
+			return PDO_MIMER_OUT_OF_MEMORY;
+		if (!MIMER_SUCCEEDED(return_code = MimerColumnName8(statement, colno, (*names)[colno - 1], return_code + 1)))
+			return return_code;
+	}
+
+	return MIMER_SUCCESS;
+}
+
+
+void pdo_mimer_worker_column_names_free(char **names, int num_columns) {
+	if (names == NULL)
+		return;
+
+	for (int i = 0; i < num_columns; i++)
+		free(names[i]);
+	free(names);
+}
+
+
+/**
+ * @brief Turns the column names read by a worker into strings, on the PHP thread.
+ * @return The strings, interned on the connection like the column names of its statements; to release with
+ * <code>pdo_mimer_worker_names_release()</code>.
+ */
+zend_string **pdo_mimer_worker_names_init(pdo_mimer_dbh *mimer_dbh, char **names, int num_columns) {
+	zend_string **strings = safe_emalloc(num_columns, sizeof(zend_string *), 0);
+
+	for (int colno = 0; colno < num_columns; colno++)
+		strings[colno] = pdo_mimer_intern_column_name(mimer_dbh, names[colno], strlen(names[colno]));
+
+	return strings;
+}
+
+
+void pdo_mimer_worker_names_release(zend_string **names, int num_columns) {
+	if (names == NULL)
+		return;
+
+	for (int colno = 0; colno < num_columns; colno++)
+		zend_string_release(names[colno]);
+	efree(names);
+}
+
+
+/**
+ * @brief Builds the zval of a row decoded by a worker, on the PHP thread.
+ * @param names [in] The column names to key the row by, NULL to key it by column number.
+ * @param strings [in|out] How string values are converted, as for the rows of a statement.
+ * @param result [out] The row, an array.
+ */
+void pdo_mimer_worker_row_zval(const pdo_mimer_rows *rows, int row, zend_string **names, pdo_mimer_strings *strings,
+	zval *result) {
+	array_init_size(result, rows->num_columns);
+	PDO_MIMER_STATS_INC(rows_fetched);
+
+	for (int colno = 0; colno < rows->num_columns; colno++) {
+		const char *bytes;
+		zval value;
+
+		ZVAL_NULL(&value);
+		pdo_mimer_value_zval(pdo_mimer_rows_get(rows, row, colno, &bytes), bytes, strings, colno, &value);
+		if (PDO_MIMER_STATS_ENABLED())
+			pdo_mimer_stats_cell(rows->column_types[colno], &value);
+
+		if (names != NULL)
+			zend_symtable_update(Z_ARRVAL_P(result), names[colno], &value);
+		else
+			zend_hash_next_index_insert_new(Z_ARRVAL_P(result), &value);
+	}
+}
+
+
+/**
+ * @brief Records an error raised by the Mimer SQL C API, reading it while its handle is still around.
+ * @remark Worker thread.
+ */
+void pdo_mimer_worker_api_error(pdo_mimer_worker_error *error, MimerHandle handle) {
+	MimerReturnCode return_code = MimerGetError8(handle, &error->code, NULL, 0);
+
+	if (MIMER_SUCCEEDED(return_code) && (error->msg = malloc(return_code + 1)) != NULL &&
+		!MIMER_SUCCEEDED(MimerGetError8(handle, &error->code, error->msg, return_code + 1)))
+		error->msg[0] = '\0';
+
+	if (!MIMER_SUCCEEDED(return_code))
+		error->code = return_code;
+
+	strcpy(error->sqlstate, pdo_mimer_get_sqlstate(error->code));
+}
+
+
+/**
+ * @brief Records an error raised by the driver itself.
+ * @remark Worker thread.
+ */
+void pdo_mimer_worker_custom_error(pdo_mimer_worker_error *error, const char *sqlstate, MimerErrorCode code,
+	const char *msg) {
+	error->code = code;
+	error->msg = pdo_mimer_worker_strdup(msg, strlen(msg));
+	strcpy(error->sqlstate, sqlstate);
+}
+
+
+/**
+ * @brief Records the error matching a return code of a worker, taking API errors from @p handle.
+ * @remark Worker thread.
+ */
+void pdo_mimer_worker_error_from(pdo_mimer_worker_error *error, MimerReturnCode return_code, MimerHandle handle) {
+	if (return_code == PDO_MIMER_OUT_OF_MEMORY)
+		pdo_mimer_worker_custom_error(error, SQLSTATE_MEMORY_ALLOCATION_ERROR, return_code, "Out of memory");
+	else if (return_code == PDO_MIMER_EMBEDDED_NUL)
+		pdo_mimer_worker_custom_error(error, SQLSTATE_INVALID_PARAMETER_VALUE, return_code,
+			"String parameter contains a NUL character");
+	else if (!MIMER_SUCCEEDED(return_code))
+		pdo_mimer_worker_api_error(error, handle);
+}
+
+
+void pdo_mimer_worker_error_free(pdo_mimer_worker_error *error) {
+	free(error->msg);
+	error->msg = NULL;
+}
+
+
+/**
+ * @brief Sets the error of a worker on the connection, without reporting it.
+ * @return true if the worker failed
+ */
+bool pdo_mimer_worker_set_error(pdo_dbh_t *dbh, const pdo_mimer_worker_error *error) {
+	if (error->code == MIMER_SUCCESS)
+		return false;
+
+	pdo_mimer_set_error(dbh, NULL, error->sqlstate, error->code, error->msg != NULL ? error->msg : "");
+	return true;
+}
+
+
+/**
+ * @brief Adds the error of a worker to an array, like <code>PDO::errorInfo()</code>, or null if it succeeded.
+ */
+void pdo_mimer_worker_add_error(zval *array, const char *key, const pdo_mimer_worker_error *error) {
+	zval error_info;
+
+	if (error->code == MIMER_SUCCESS) {
+		add_assoc_null(array, key);
+		return;
+	}
+
+	array_init_size(&error_info, 3);
+	add_next_index_string(&error_info, error->sqlstate);
+	add_next_index_long(&error_info, error->code);
+	add_next_index_string(&error_info, error->msg != NULL ? error->msg : "");
+	add_assoc_zval(array, key, &error_info);
+}
+
+
+/**
+ * @brief Takes a session for a worker from the connection's pool or, if none is idle, copies the connection's
+ * credentials for the worker to begin one with.
+ * @return false if out of memory
+ * @remark A session to be begun is counted as opened here, since the worker thread cannot count it.
+ */
+bool pdo_mimer_worker_session_take(pdo_dbh_t *dbh, pdo_mimer_worker_session *worker_session) {
+	pdo_mimer_dbh *mimer_dbh = dbh->driver_data;
+
+	memset(worker_session, 0, sizeof(*worker_session));
+	worker_session->session = MIMERNULLHANDLE;
+
+	if (mimer_dbh->async.num_idle > 0) {
+		worker_session->session = mimer_dbh->async.idle[--mimer_dbh->async.num_idle];
+		return true;
+	}
+
+	PDO_MIMER_STATS_INC(sessions_opened);
+	worker_session->db_name = pdo_mimer_worker_strdup(mimer_dbh->async.db_name,
+		mimer_dbh->async.db_name != NULL ? strlen(mimer_dbh->async.db_name) : 0);
+	worker_session->username = pdo_mimer_worker_strdup(dbh->username, dbh->username != NULL ? strlen(dbh->username) : 0);
+	worker_session->password = pdo_mimer_worker_strdup(dbh->password, dbh->password != NULL ? strlen(dbh->password) : 0);
+
+	return (worker_session->db_name != NULL) == (mimer_dbh->async.db_name != NULL) &&
+		(worker_session->username != NULL) == (dbh->username != NULL) &&
+		(worker_session->password != NULL) == (dbh->password != NULL);
+}
+
+
+/**
+ * @brief Begins the session of a worker, unless it was taken from the pool.
+ * @return false if the session could not be begun, with @p error set
+ * @remark Worker thread.
+ */
+bool pdo_mimer_worker_session_begin(pdo_mimer_worker_session *worker_session, pdo_mimer_worker_error *error) {
+	if (worker_session->session != MIMERNULLHANDLE)
+		return true;
+
+	if (MIMER_SUCCEEDED(MimerBeginSession8(worker_session->db_name, worker_session->username,
+		worker_session->password, &worker_session->session)))
+		return true;
+
+	pdo_mimer_worker_api_error(error, (MimerHandle) worker_session->session);
+	MimerEndSession(&worker_session->session);
+	worker_session->session = MIMERNULLHANDLE;
+	return false;
+}
+
+
+/**
+ * @brief Gives the session of a finished worker back to the connection's pool, and frees the credentials.
+ * @param mimer_dbh [in] The connection, NULL if it is gone.
+ * @param error [in] The worker's error; a session left broken by a connection error is ended rather than given back,
+ * as is one the pool has no room for.
+ */
+void pdo_mimer_worker_session_release(pdo_mimer_dbh *mimer_dbh, pdo_mimer_worker_session *worker_session,
+	const pdo_mimer_worker_error *error) {
+	bool is_broken = error->code != MIMER_SUCCESS && strncmp(error->sqlstate, "08", 2) == 0;
+
+	if (worker_session->session != MIMERNULLHANDLE) {
+		if (!is_broken && mimer_dbh != NULL && mimer_dbh->async.num_idle < PDO_MIMER_ASYNC_POOL_SIZE)
+			mimer_dbh->async.idle[mimer_dbh->async.num_idle++] = worker_session->session;
+		else
+			MimerEndSession(&worker_session->session);
+	}
+
+	free(worker_session->db_name);
+	free(worker_session->username);
+	free(worker_session->password);
+	memset(worker_session, 0, sizeof(*worker_session));
+	worker_session->session = MIMERNULLHANDLE;
+}
@@ -45,24 +45,57 @@ ZEND_TSRMLS_CACHE_DEFINE()
 ZEND_GET_MODULE(pdo_mimer)
 #endif
 
+ZEND_DECLARE_MODULE_GLOBALS(pdo_mimer)
+
+PHP_INI_BEGIN()
+    STD_PHP_INI_ENTRY("pdo_mimer.warmup_file", "", PHP_INI_ALL, OnUpdateString, warmup_file,
+                      zend_pdo_mimer_globals, pdo_mimer_globals)
+    STD_PHP_INI_BOOLEAN("pdo_mimer.stats", "0", PHP_INI_ALL, OnUpdateBool, stats_enabled,
+                        zend_pdo_mimer_globals, pdo_mimer_globals)
+PHP_INI_END()
+
 #define REGISTER_ATTR(x) REGISTER_PDO_CLASS_CONST_LONG(#x, (x))
 
+static PHP_GINIT_FUNCTION(pdo_mimer) {
+#if defined(COMPILE_DL_PDO_MIMER) && defined(ZTS)
+    ZEND_TSRMLS_CACHE_UPDATE();
+#endif
+    memset(pdo_mimer_globals, 0, sizeof(*pdo_mimer_globals));
+}
+
 PHP_MINIT_FUNCTION(pdo_mimer) {
+    REGISTER_INI_ENTRIES();
+
     if (FAILURE == php_pdo_register_driver(&pdo_mimer_driver)) {
         return FAILURE;
     }
 
+    pdo_mimer_sqlstate_map_init();
+    pdo_mimer_async_register_class();
+    pdo_mimer_parallel_register_class();
+
     /* register custom attributes here */
     REGISTER_ATTR(MIMER_ATTR_TRANS_OPTION)
+    REGISTER_ATTR(MIMER_ATTR_WARMUP_STATS)
+    REGISTER_ATTR(MIMER_ATTR_RETRY_STATS)
+    REGISTER_ATTR(MIMER_ATTR_DEFERRED_BEGIN)
+    REGISTER_ATTR(MIMER_ATTR_FETCH_SIZE)
+    REGISTER_ATTR(MIMER_ATTR_MAX_ROWS)
+    REGISTER_ATTR(MIMER_ATTR_QUERY_TIMEOUT)
+    REGISTER_ATTR(MIMER_ATTR_DEDUP_STRINGS)
+    REGISTER_ATTR(MIMER_ATTR_TRIM_CHAR)
+    REGISTER_ATTR(MIMER_ATTR_PREFETCH_ROWS)
     REGISTER_ATTR(MIMER_TRANS_DEFAULT)
     REGISTER_ATTR(MIMER_TRANS_READWRITE)
     REGISTER_ATTR(MIMER_TRANS_READONLY)
+    REGISTER_ATTR(MIMER_PARAM_ARRAY)
 
     return SUCCESS;
 }
 
 PHP_MSHUTDOWN_FUNCTION(pdo_mimer) {
     php_pdo_unregister_driver(&pdo_mimer_driver);
+    UNREGISTER_INI_ENTRIES();
 
     return SUCCESS;
 }
@@ -72,6 +105,10 @@ PHP_MINFO_FUNCTION(pdo_mimer) {
     php_info_print_table_header(2, "PDO Driver for Mimer SQL", "enabled");
     php_info_print_table_row(2, "Mimer API Version", MimerAPIVersion());
     php_info_print_table_end();
+
+    pdo_mimer_stats_info();
+
+    DISPLAY_INI_ENTRIES();
 }
 
 /* For compatibility with older PHP versions */
@@ -98,5 +135,9 @@ zend_module_entry pdo_mimer_module_entry = {
         NULL,
         PHP_MINFO(pdo_mimer),
         PHP_PDO_MIMER_VERSION,
-        STANDARD_MODULE_PROPERTIES
+        PHP_MODULE_GLOBALS(pdo_mimer),
+        PHP_GINIT(pdo_mimer),
+        NULL,
+        NULL,
+        STANDARD_MODULE_PROPERTIES_EX
 };
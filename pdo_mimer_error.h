@@ -41,8 +41,17 @@ typedef int32_t MimerErrorCode;
  ********************************************/
 
 extern void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE, int LINE);
+extern void pdo_mimer_error_from(pdo_dbh_t *dbh, pdo_stmt_t *stmt, MimerHandle handle, const char *FILE, int LINE);
+extern void pdo_mimer_set_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *sqlstate, MimerErrorCode code,
+                                const char *msg);
+extern const char *pdo_mimer_error_msg(pdo_dbh_t *dbh);
+extern const char *pdo_mimer_get_sqlstate(MimerErrorCode error_code);
+extern bool pdo_mimer_sqlstate_is_transient(const char *sqlstate);
+extern void pdo_mimer_sqlstate_map_init(void);
 #define pdo_mimer_dbh_error() pdo_mimer_error(dbh, NULL, __FILE__, __LINE__)
 #define pdo_mimer_stmt_error() pdo_mimer_error(stmt->dbh, stmt, __FILE__, __LINE__)
+#define pdo_mimer_custom_error(stmt, sqlstate, code, msg) pdo_mimer_set_error((stmt)->dbh, (stmt), (sqlstate), (code), (msg))
+#define pdo_mimer_session_error(session) pdo_mimer_error_from(dbh, NULL, (MimerHandle) (session), __FILE__, __LINE__)
 
 
 /********************************************
@@ -128,6 +137,7 @@ extern void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE,
 #define SQLSTATE_INVALID_CURSOR_NAME "34000"
 #define SQLSTATE_INVALID_CONDITION_NUMBER "35000"
 #define SQLSTATE_SYNTAX_ERROR_OR_ACCESS_VIOLATION_IN_PREPARE_OR_EXECUTE_IMMEDIATE "37000"
+#define SQLSTATE_INVALID_SAVEPOINT_SPECIFICATION "3B001"
 #define SQLSTATE_AMBIGUOUS_CURSOR_NAME "3C000"
 #define SQLSTATE_TRANSACTION_ROLLBACK "40000"
 #define SQLSTATE_SERIALIZATION_FAILURE "40001"
@@ -184,9 +194,33 @@ extern void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE,
 #define SQLSTATE_OPTIONAL_FEATURE_NOT_IMPLEMENTED "HYC00"
 #define SQLSTATE_TIMEOUT_EXPIRED "HYT00"
 #define SQLSTATE_CONNECTION_TIMEOUT_EXPIRED "HYT01"
+#define SQLSTATE_DRIVER_DOES_NOT_SUPPORT_FUNCTION "IM001"
 
-/* TODO: pdo_error mappings to native Mimer SQL error codes */
-#define MimerGetSQLState(mimer_error) SQLSTATE_GENERAL_ERROR
+/**
+ * @brief An entry in the mapping from native error codes to SQLSTATEs, covering the codes @p first to @p last.
+ */
+typedef struct pdo_mimer_sqlstate_map_entry_t {
+    MimerErrorCode first;
+    MimerErrorCode last;
+    const char *sqlstate;
+} pdo_mimer_sqlstate_map_entry;
+
+#define MimerGetSQLState(mimer_error) pdo_mimer_get_sqlstate(mimer_error)
+
+
+/********************************************
+ *        Mimer SQL native return codes     *
+ ********************************************/
+
+/* mimerrors.h names the C API's own codes only, the server's are grouped in ranges by the kind of error */
+#define MIMER_RC_CONSTRAINT_FIRST     (-10199) /* integrity constraint violations, e.g. a duplicate key */
+#define MIMER_RC_CONSTRAINT_LAST      (-10100)
+#define MIMER_RC_DATA_FIRST           (-10399) /* data exceptions, e.g. an overflow or a bad datetime value */
+#define MIMER_RC_DATA_LAST            (-10300)
+#define MIMER_RC_COMPILER_FIRST       (-12999) /* SQL compiler errors */
+#define MIMER_RC_COMPILER_LAST        (-12000)
+#define MIMER_RC_COMMUNICATION_FIRST  (-18999) /* communication errors */
+#define MIMER_RC_COMMUNICATION_LAST   (-18000)
 
 
 /********************************************
@@ -194,6 +228,9 @@ extern void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE,
  ********************************************/
 
 #define PDO_MIMER_LOGIN_ERROR			  (90)
+#define PDO_MIMER_TRANSACTION_CONFLICT    (-10001)
+#define PDO_MIMER_LOGIN_FAILURE           (-14006)
+#define PDO_MIMER_INCOMPLETE_PARAMETERS   (-24103)
 #define PDO_MIMER_GENERAL_ERROR           (-100000)
 #define PDO_MIMER_FEATURE_NOT_IMPLEMENTED (-100001)
 #define PDO_MIMER_VALUE_TOO_LARGE         (-100002)
@@ -202,6 +239,10 @@ extern void pdo_mimer_error(pdo_dbh_t *dbh, pdo_stmt_t *stmt, const char *FILE,
 #define PDO_MIMER_UNKNOWN_LOB_TYPE        (-100006)
 #define PDO_MIMER_UNABLE_PHPSTREAM_ALLOC  (-100007)
 #define PDO_MIMER_UNKNOWN_COLUMN_TYPE     (-100008)
+#define PDO_MIMER_QUERY_TIMEOUT           (-100009)
+#define PDO_MIMER_UNSUPPORTED_ATTRIBUTE   (-100010)
+#define PDO_MIMER_OUT_OF_MEMORY           (-100011)
+#define PDO_MIMER_EMBEDDED_NUL            (-100012)
 
 #define isPDOMimerReturnCode(code) ((code) <= PDO_MIMER_GENERAL_ERROR)
 
@@ -0,0 +1,123 @@
+/*
+   +--------------------------------------------------------------------------------+
+   | MIT License                                                                    |
+   +--------------------------------------------------------------------------------+
+   | Copyright (c) 2023 Mimer Information Technology AB                             |
+   +--------------------------------------------------------------------------------+
+   | Permission is hereby granted, free of charge, to any person obtaining a copy   |
+   | of this software and associated documentation files (the "Software"), to deal  |
+   | in the Software without restriction, including without limitation the rights   |
+   | to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      |
+   | copies of the Software, and to permit persons to whom the Software is          |
+   | furnished to do so, subject to the following conditions:                       |
+   |                                                                                |
+   | The above copyright notice and this permission notice shall be included in all |
+   | copies or substantial portions of the Software.                                |
+   |                                                                                |
+   | THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     |
+   | IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       |
+   | FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    |
+   | AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         |
+   | LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  |
+   | OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  |
+   | SOFTWARE.                                                                      |
+   +--------------------------------------------------------------------------------+
+   | Authors: Alexander Hedberg <alexander.hedberg@mimer.com>                       |
+   |          Ludwig von Feilitzen <ludwig.vonfeilitzen@mimer.com>                  |
+   +--------------------------------------------------------------------------------+
+*/
+
+#ifndef PDO_MIMER_THREAD_H
+#define PDO_MIMER_THREAD_H
+
+/* the few threading primitives the driver's helper threads need, on top of pthreads or the Win32 API */
+
+#ifdef PHP_WIN32
+# include <windows.h>
+
+typedef SRWLOCK pdo_mimer_mutex;
+typedef CONDITION_VARIABLE pdo_mimer_cond;
+typedef HANDLE pdo_mimer_thread;
+typedef DWORD (WINAPI *pdo_mimer_thread_func)(void *arg);
+# define PDO_MIMER_THREAD_FUNC(name, arg) static DWORD WINAPI name(void *arg)
+# define PDO_MIMER_THREAD_RETURN return 0
+
+static inline void pdo_mimer_mutex_init(pdo_mimer_mutex *mutex) { InitializeSRWLock(mutex); }
+static inline void pdo_mimer_mutex_destroy(pdo_mimer_mutex *mutex) { }
+static inline void pdo_mimer_mutex_lock(pdo_mimer_mutex *mutex) { AcquireSRWLockExclusive(mutex); }
+static inline void pdo_mimer_mutex_unlock(pdo_mimer_mutex *mutex) { ReleaseSRWLockExclusive(mutex); }
+
+static inline void pdo_mimer_cond_init(pdo_mimer_cond *cond) { InitializeConditionVariable(cond); }
+static inline void pdo_mimer_cond_destroy(pdo_mimer_cond *cond) { }
+static inline void pdo_mimer_cond_signal(pdo_mimer_cond *cond) { WakeConditionVariable(cond); }
+static inline void pdo_mimer_cond_broadcast(pdo_mimer_cond *cond) { WakeAllConditionVariable(cond); }
+static inline void pdo_mimer_cond_wait(pdo_mimer_cond *cond, pdo_mimer_mutex *mutex) {
+	SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+/**
+ * @brief Waits on a condition for at most the given time, spurious wake-ups included.
+ * @param timeout_ns [in] The longest time to wait, in nanoseconds.
+ */
+static inline void pdo_mimer_cond_timedwait(pdo_mimer_cond *cond, pdo_mimer_mutex *mutex, uint64_t timeout_ns) {
+	uint64_t timeout_ms = (timeout_ns + 999999) / 1000000;
+	SleepConditionVariableSRW(cond, mutex, timeout_ms >= INFINITE ? INFINITE - 1 : (DWORD) timeout_ms, 0);
+}
+
+static inline bool pdo_mimer_thread_create(pdo_mimer_thread *thread, pdo_mimer_thread_func func, void *arg) {
+	return (*thread = CreateThread(NULL, 0, func, arg, 0, NULL)) != NULL;
+}
+
+static inline void pdo_mimer_thread_join(pdo_mimer_thread thread) {
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+#else
+# include <pthread.h>
+# include <time.h>
+
+typedef pthread_mutex_t pdo_mimer_mutex;
+typedef pthread_cond_t pdo_mimer_cond;
+typedef pthread_t pdo_mimer_thread;
+typedef void *(*pdo_mimer_thread_func)(void *arg);
+# define PDO_MIMER_THREAD_FUNC(name, arg) static void *name(void *arg)
+# define PDO_MIMER_THREAD_RETURN return NULL
+
+static inline void pdo_mimer_mutex_init(pdo_mimer_mutex *mutex) { pthread_mutex_init(mutex, NULL); }
+static inline void pdo_mimer_mutex_destroy(pdo_mimer_mutex *mutex) { pthread_mutex_destroy(mutex); }
+static inline void pdo_mimer_mutex_lock(pdo_mimer_mutex *mutex) { pthread_mutex_lock(mutex); }
+static inline void pdo_mimer_mutex_unlock(pdo_mimer_mutex *mutex) { pthread_mutex_unlock(mutex); }
+
+static inline void pdo_mimer_cond_init(pdo_mimer_cond *cond) { pthread_cond_init(cond, NULL); }
+static inline void pdo_mimer_cond_destroy(pdo_mimer_cond *cond) { pthread_cond_destroy(cond); }
+static inline void pdo_mimer_cond_signal(pdo_mimer_cond *cond) { pthread_cond_signal(cond); }
+static inline void pdo_mimer_cond_broadcast(pdo_mimer_cond *cond) { pthread_cond_broadcast(cond); }
+static inline void pdo_mimer_cond_wait(pdo_mimer_cond *cond, pdo_mimer_mutex *mutex) {
+	pthread_cond_wait(cond, mutex);
+}
+
+/**
+ * @brief Waits on a condition for at most the given time, spurious wake-ups included.
+ * @param timeout_ns [in] The longest time to wait, in nanoseconds.
+ * @remark The condition uses the realtime clock, a clock change only makes the wait end early or late once.
+ */
+static inline void pdo_mimer_cond_timedwait(pdo_mimer_cond *cond, pdo_mimer_mutex *mutex, uint64_t timeout_ns) {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	uint64_t nsec = (uint64_t) ts.tv_nsec + timeout_ns % 1000000000;
+	ts.tv_sec += (time_t) (timeout_ns / 1000000000 + nsec / 1000000000);
+	ts.tv_nsec = (long) (nsec % 1000000000);
+	pthread_cond_timedwait(cond, mutex, &ts);
+}
+
+static inline bool pdo_mimer_thread_create(pdo_mimer_thread *thread, pdo_mimer_thread_func func, void *arg) {
+	return pthread_create(thread, NULL, func, arg) == 0;
+}
+
+static inline void pdo_mimer_thread_join(pdo_mimer_thread thread) {
+	pthread_join(thread, NULL);
+}
+#endif
+
+#endif /* PDO_MIMER_THREAD_H */
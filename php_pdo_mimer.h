@@ -45,4 +45,55 @@ extern zend_module_entry pdo_mimer_module_entry;
 # include "TSRM.h"
 #endif
 
+/* kinds of decoded cells counted, by the SQL type of their column */
+typedef enum {
+	PDO_MIMER_CELL_NULL,
+	PDO_MIMER_CELL_INTEGER,
+	PDO_MIMER_CELL_FLOAT,
+	PDO_MIMER_CELL_DECIMAL,
+	PDO_MIMER_CELL_BOOLEAN,
+	PDO_MIMER_CELL_CHARACTER,
+	PDO_MIMER_CELL_BINARY,
+	PDO_MIMER_CELL_DATETIME,
+	PDO_MIMER_CELL_LOB,
+	PDO_MIMER_CELL_OTHER,
+	PDO_MIMER_NUM_CELL_KINDS
+} pdo_mimer_cell_kind;
+
+/* SQLSTATE classes are two characters out of [0-9A-Z] */
+#define PDO_MIMER_NUM_SQLSTATE_CLASSES (36 * 36)
+
+/**
+ * @brief The driver's performance counters, see <code>pdo_mimer.stats</code>.
+ */
+typedef struct {
+	uint64_t sessions_opened;
+	uint64_t prepares;
+	uint64_t stmt_cache_hits;      /* prepares saved by reusing a warmed up or an array parameter statement */
+	uint64_t executes;
+	uint64_t rows_fetched;
+	uint64_t cells[PDO_MIMER_NUM_CELL_KINDS];
+	uint64_t bytes_in;             /* values fetched as strings, and LOB data */
+	uint64_t bytes_out;            /* string, binary and LOB data sent as parameters */
+	uint64_t lob_bytes;            /* LOB data, fetched or sent */
+	uint64_t errors;
+	uint64_t errors_by_class[PDO_MIMER_NUM_SQLSTATE_CLASSES];
+	uint64_t prepare_ns;
+	uint64_t execute_ns;
+	uint64_t fetch_ns;
+} pdo_mimer_stats;
+
+ZEND_BEGIN_MODULE_GLOBALS(pdo_mimer)
+	char *warmup_file;
+	bool stats_enabled;
+	pdo_mimer_stats stats;
+ZEND_END_MODULE_GLOBALS(pdo_mimer)
+
+ZEND_EXTERN_MODULE_GLOBALS(pdo_mimer)
+#define PDO_MIMER_G(v) ZEND_MODULE_GLOBALS_ACCESSOR(pdo_mimer, v)
+
+#if defined(ZTS) && defined(COMPILE_DL_PDO_MIMER)
+ZEND_TSRMLS_CACHE_EXTERN()
+#endif
+
 #endif	/* PHP_PDO_MIMER_H */
@@ -33,12 +33,20 @@
 #include <mimerrors.h>
 #include "pdo_mimer_error.h"
 
+#ifndef PHP_WIN32
+# include <time.h>
+#endif
+
 #if defined(ZTS) && defined(COMPILE_DL_PDO_MIMER)
 ZEND_TSRMLS_CACHE_EXTERN()
 #endif
 
 extern const pdo_driver_t pdo_mimer_driver;
 extern const struct pdo_stmt_methods pdo_mimer_stmt_methods;
+extern bool pdo_mimer_ensure_transaction(pdo_dbh_t *dbh);
+extern bool pdo_mimer_reads_may_route(pdo_dbh_t *dbh);
+extern const char *pdo_mimer_sql_skip(const char *p, const char *end);
+extern const char *pdo_mimer_script_next(const char **cursor, const char *end, const char **stmt_end);
 
 
 /********************************************
@@ -48,31 +56,317 @@ extern const struct pdo_stmt_methods pdo_mimer_stmt_methods;
 /* Mimer SQL C API uses int32_t as return codes and returned data, this typedef exists to simply increase readability */
 typedef int32_t MimerReturnCode;
 
+/* initial size of the connection's error message buffer */
+#define PDO_MIMER_ERROR_MSG_MIN_SIZE 256
+
+/* max number of rewritten statements remembered per connection, the cache is emptied when full */
+#define PDO_MIMER_REWRITE_CACHE_SIZE 512
+
+/* max number of column names interned per connection, the table is emptied when full */
+#define PDO_MIMER_COLUMN_NAMES_SIZE 1024
+
+/* column names up to this length, in bytes, are read without asking for their length first */
+#define PDO_MIMER_COLUMN_NAME_BUF 256
+
+/* values per column kept by MIMER_ATTR_DEDUP_STRINGS, the longest value shared, and the lookups after which a column
+ * whose values were not found at least half of the time stops being deduplicated */
+#define PDO_MIMER_DEDUP_SIZE 256
+#define PDO_MIMER_DEDUP_MAX_LEN 64
+#define PDO_MIMER_DEDUP_PROBE 1024
+
+/* the smallest scratch buffer of a statement, and the largest one kept from one execute() to the next */
+#define PDO_MIMER_SCRATCH_MIN_SIZE 256
+#define PDO_MIMER_SCRATCH_KEEP_SIZE (64 * 1024)
+
+/* defaults for the retry loop of mimerTransaction(), overridable through its options */
+#define PDO_MIMER_RETRY_ATTEMPTS 3
+#define PDO_MIMER_RETRY_BACKOFF_MS 10
+#define PDO_MIMER_RETRY_MAX_BACKOFF_MS 1000
+
+/* idle sessions kept per connection for the worker threads of mimerQueryAsync() and mimerParallelInsert(), more are
+ * ended as their work finishes */
+#define PDO_MIMER_ASYNC_POOL_SIZE 8
+
+/* max sessions of mimerParallelInsert() and mimerParallelScan(), and the rows per round trip of the former */
+#define PDO_MIMER_PARALLEL_MAX_SESSIONS 64
+#define PDO_MIMER_PARALLEL_BATCH_SIZE 1000
+
+/**
+ * @brief How PDO rewrote a prepared SQL statement, cached per connection and keyed by the original SQL.
+ */
+typedef struct pdo_mimer_rewrite_entry_t {
+	zend_string *sql; /* rewritten SQL, NULL if the original is sent as is */
+	bool is_persistent;
+	uint32_t num_params;
+	struct {
+		zend_ulong position;
+		zend_string *name;
+	} params[1]; /* named placeholder per position, in the order of PDO's bound_param_map */
+} pdo_mimer_rewrite_entry;
+
 typedef struct {
 	struct {
 		bool is_in_transaction:1;
 		bool is_read_only:1;
+		bool is_deferred:1;          /* beginTransaction() waits for the first statement to start the transaction */
+		bool is_begin_pending:1;     /* transaction begun by PDO but not yet on the server */
+		bool is_pending_read_only:1; /* access mode recorded when the pending transaction was begun */
+		HashTable *savepoints;       /* names of the savepoints set in the transaction, oldest first */
 	} transaction;
 
 	struct {
 		MimerErrorCode code;
-		char *msg;
+		MimerHandle handle; /* handle to fetch the message from, NULL once it has been fetched */
+		size_t msg_len;     /* length of the message still to be fetched */
+		char *msg;          /* reused for every error on the connection */
+		size_t msg_size;
+		bool is_set:1;
 		char sqlstate[6];
 	} error;
 
+	struct {
+		HashTable *statements; /* SQL text => MimerStatement prepared at session start */
+		uint32_t prepared;
+		uint32_t failed;
+		uint32_t used;
+		uint64_t time_ns;
+	} warmup;
+
+	struct {
+		uint64_t transactions; /* units of work run through mimerTransaction() */
+		uint64_t retries;
+		uint64_t conflicts;
+	} retry;
+
+	HashTable *rewrite_cache; /* original SQL => pdo_mimer_rewrite_entry */
+	HashTable *column_names;  /* column name => the same zend_string, shared by the statements' columns */
+	zend_long query_timeout;  /* MIMER_ATTR_QUERY_TIMEOUT of new statements, 0 for no limit */
+	struct pdo_mimer_prefetch_t *prefetching; /* the prefetch last resumed, which may be using a session */
+
+	struct {
+		char *db_name;       /* database of the connection, to begin the sessions of worker threads with */
+		int num_idle;
+		MimerSession idle[PDO_MIMER_ASYNC_POOL_SIZE];
+	} async;
+
 	MimerSession session;
+	MimerSession read_session; /* optional session reads are routed to, MIMERNULLHANDLE if none */
 } pdo_mimer_dbh;
 
+/**
+ * @brief Values recently fetched from a string column, shared by the rows they were fetched for.
+ */
+typedef struct pdo_mimer_dedup_column_t {
+	HashTable values;  /* value => the zend_string handed out for it */
+	uint32_t lookups;
+	uint32_t hits;
+	bool is_off:1;     /* too few hits to be worth the lookups, values is destroyed */
+} pdo_mimer_dedup_column;
+
+/**
+ * @brief How the string values of a result set are turned into zvals, as set by MIMER_ATTR_TRIM_CHAR and
+ * MIMER_ATTR_DEDUP_STRINGS, whether they are read from the API or were decoded by another thread.
+ */
+typedef struct pdo_mimer_strings_t {
+	bool is_char_trimmed:1;          /* trailing spaces are removed from CHAR and NCHAR values */
+	bool is_deduped:1;               /* repeated values share one string */
+	int num_columns;
+	pdo_mimer_dedup_column *columns; /* per column, allocated at the first value deduplicated */
+} pdo_mimer_strings;
+
+/**
+ * @brief A value decoded from the Mimer SQL C API, on any thread, turned into a zval by the PHP thread.
+ */
+typedef struct pdo_mimer_value_t {
+	enum {
+		PDO_MIMER_VALUE_NULL,
+		PDO_MIMER_VALUE_LONG,
+		PDO_MIMER_VALUE_BOOL,
+		PDO_MIMER_VALUE_DOUBLE,
+		PDO_MIMER_VALUE_BYTES,
+	} kind;
+	bool is_string:1;  /* bytes of a character column */
+	bool is_padded:1;  /* bytes of a CHAR or NCHAR column */
+	size_t len;        /* number of bytes */
+	union {
+		int64_t lval;
+		double dval;
+		size_t offset; /* of the bytes in the rows' data */
+	} u;
+} pdo_mimer_value;
+
+/**
+ * @brief Rows of a result set decoded off the PHP thread, by the prefetch thread or an asynchronous query, or the value
+ * being read by the PHP thread.
+ * @remark Only plain malloc() memory is used, as the threads filling the rows must not touch the Zend engine.
+ */
+typedef struct pdo_mimer_rows_t {
+	int num_columns;
+	int32_t *column_types;
+	pdo_mimer_value *values; /* num_rows rows of num_columns values */
+	size_t values_size;      /* number of values there is room for */
+	char *data;              /* the bytes of the values */
+	size_t data_size;
+	size_t data_used;
+	int num_rows;
+} pdo_mimer_rows;
+
+/**
+ * @brief A parameter value converted on the PHP thread for a worker thread, to each type the parameter may have.
+ */
+typedef struct pdo_mimer_worker_param_t {
+	bool is_null;
+	bool bval;
+	int64_t lval;
+	double dval;
+	char *str;  /* malloc()'ed */
+	size_t len;
+} pdo_mimer_worker_param;
+
+/**
+ * @brief An error raised on a worker thread, reported on the PHP thread once the worker is done.
+ */
+typedef struct pdo_mimer_worker_error_t {
+	MimerErrorCode code; /* MIMER_SUCCESS if there was no error */
+	char sqlstate[6];
+	char *msg;           /* malloc()'ed */
+} pdo_mimer_worker_error;
+
+/**
+ * @brief The session of a worker thread, taken from the connection's pool or begun by the worker with a copy of the
+ * connection's credentials.
+ */
+typedef struct pdo_mimer_worker_session_t {
+	MimerSession session; /* MIMERNULLHANDLE until begun */
+	char *db_name;
+	char *username;
+	char *password;
+} pdo_mimer_worker_session;
+
+typedef struct pdo_mimer_prefetch_t pdo_mimer_prefetch;
+
 typedef struct pdo_mimer_stmt_t {
 	struct {
 		bool is_open:1;
 		bool is_scrollable:1;
 	} cursor;
 
+	bool is_read_query:1;      /* may run on the read session, see pdo_mimer_reads_may_route() */
+	bool is_on_read_session:1; /* stmt runs outside of the primary session's transactions */
+
+	struct {
+		int32_t fetch_size; /* rows fetched per round-trip, 0 for the API's default */
+		zend_long max_rows; /* rows fetched before the cursor is closed, 0 for no limit */
+		zend_long timeout;  /* seconds a query may take, 0 for no limit */
+	} limits;
+	zend_long rows_fetched;
+	uint64_t deadline;         /* hrtime when the running query times out, 0 if it does not */
+
+	zend_string *sql;          /* the SQL prepared, after PDO's placeholder rewrite */
+
+	struct {
+		zend_long rows;            /* rows fetched ahead by a thread, 0 to fetch them when asked for */
+		pdo_mimer_prefetch *state; /* the running prefetch thread, NULL if none */
+	} prefetch;
+
+	pdo_mimer_strings strings;
+
+	struct {
+		char *buf;                 /* transient buffer for values read before they are converted */
+		size_t size;
+	} scratch;
+	pdo_mimer_rows value;          /* the bytes of the value being read without prefetch */
+
+	struct {
+		bool is_bound:1;           /* a parameter was bound with PDO::MIMER_PARAM_ARRAY */
+		uint32_t num_placeholders;
+		uint32_t *placeholders;    /* offset of each placeholder in sql */
+		unsigned char *shape;      /* per placeholder, log2 of the number of placeholders it is expanded to */
+		HashTable *statements;     /* shape and session => MimerStatement prepared for it */
+	} arrays;
+
+	struct {
+		MimerStatement primary;    /* prepared on the primary session, MIMERNULLHANDLE until routed there */
+		MimerStatement read;       /* prepared on the read session, MIMERNULLHANDLE until routed there */
+	} routes;
+
 	pdo_mimer_dbh *dbh;
-	MimerStatement stmt;
+	MimerStatement stmt;           /* the statement executed, one of routes or one shaped for bound arrays */
 } pdo_mimer_stmt;
 
+/* the session a statement is executed on */
+#define pdo_mimer_stmt_session(mimer_stmt) \
+	((mimer_stmt)->is_on_read_session ? (mimer_stmt)->dbh->read_session : (mimer_stmt)->dbh->session)
+
+extern bool pdo_mimer_value_is_decodable(int32_t column_type);
+extern MimerReturnCode pdo_mimer_value_decode(pdo_mimer_rows *rows, MimerStatement statement, int16_t colno,
+	int32_t column_type, pdo_mimer_value *value);
+extern void pdo_mimer_value_zval(const pdo_mimer_value *value, const char *bytes, pdo_mimer_strings *strings, int colno,
+	zval *result);
+extern void pdo_mimer_strings_init(pdo_mimer_strings *strings, HashTable *options);
+extern void pdo_mimer_strings_free(pdo_mimer_strings *strings);
+extern MimerReturnCode pdo_mimer_rows_init(pdo_mimer_rows *rows, MimerStatement statement, int num_columns);
+extern MimerReturnCode pdo_mimer_rows_add(pdo_mimer_rows *rows, MimerStatement statement);
+extern const pdo_mimer_value *pdo_mimer_rows_get(const pdo_mimer_rows *rows, int row, int colno, const char **bytes);
+extern void pdo_mimer_rows_clear(pdo_mimer_rows *rows);
+extern void pdo_mimer_rows_free(pdo_mimer_rows *rows);
+
+extern zend_string *pdo_mimer_intern_column_name(pdo_mimer_dbh *mimer_dbh, const char *name, size_t len);
+extern zend_long pdo_mimer_option_long(HashTable *options, const char *name, zend_long default_value);
+extern bool pdo_mimer_option_bool(HashTable *options, const char *name, bool default_value);
+
+extern char *pdo_mimer_worker_strdup(const char *str, size_t len);
+extern bool pdo_mimer_worker_param_init(pdo_mimer_worker_param *param, zval *value);
+extern void pdo_mimer_worker_param_free(pdo_mimer_worker_param *param);
+extern MimerReturnCode pdo_mimer_worker_param_set(const pdo_mimer_worker_param *param, MimerStatement statement,
+	int16_t paramno);
+extern MimerReturnCode pdo_mimer_worker_column_names(MimerStatement statement, int num_columns, char ***names);
+extern void pdo_mimer_worker_column_names_free(char **names, int num_columns);
+extern zend_string **pdo_mimer_worker_names_init(pdo_mimer_dbh *mimer_dbh, char **names, int num_columns);
+extern void pdo_mimer_worker_names_release(zend_string **names, int num_columns);
+extern void pdo_mimer_worker_row_zval(const pdo_mimer_rows *rows, int row, zend_string **names,
+	pdo_mimer_strings *strings, zval *result);
+extern void pdo_mimer_worker_api_error(pdo_mimer_worker_error *error, MimerHandle handle);
+extern void pdo_mimer_worker_custom_error(pdo_mimer_worker_error *error, const char *sqlstate, MimerErrorCode code,
+	const char *msg);
+extern void pdo_mimer_worker_error_from(pdo_mimer_worker_error *error, MimerReturnCode return_code, MimerHandle handle);
+extern void pdo_mimer_worker_error_free(pdo_mimer_worker_error *error);
+extern bool pdo_mimer_worker_set_error(pdo_dbh_t *dbh, const pdo_mimer_worker_error *error);
+extern void pdo_mimer_worker_add_error(zval *array, const char *key, const pdo_mimer_worker_error *error);
+extern bool pdo_mimer_worker_session_take(pdo_dbh_t *dbh, pdo_mimer_worker_session *worker_session);
+extern bool pdo_mimer_worker_session_begin(pdo_mimer_worker_session *worker_session, pdo_mimer_worker_error *error);
+extern void pdo_mimer_worker_session_release(pdo_mimer_dbh *mimer_dbh, pdo_mimer_worker_session *worker_session,
+	const pdo_mimer_worker_error *error);
+
+extern void pdo_mimer_async_register_class(void);
+extern void pdo_mimer_async_free_pool(pdo_mimer_dbh *mimer_dbh, bool is_persistent);
+extern void pdo_mimer_parallel_register_class(void);
+
+extern void pdo_mimer_stats_error(const char *sqlstate);
+extern void pdo_mimer_stats_cell(int32_t column_type, const zval *value);
+extern void pdo_mimer_stats_info(void);
+
+extern pdo_mimer_prefetch *pdo_mimer_prefetch_start(MimerStatement statement, int num_columns, zend_long rows);
+extern MimerReturnCode pdo_mimer_prefetch_next(pdo_mimer_prefetch *prefetch);
+extern const pdo_mimer_value *pdo_mimer_prefetch_get(pdo_mimer_prefetch *prefetch, int colno, const char **bytes);
+extern int32_t pdo_mimer_prefetch_column_type(const pdo_mimer_prefetch *prefetch, int colno);
+extern void pdo_mimer_prefetch_pause(pdo_mimer_prefetch *prefetch);
+extern void pdo_mimer_prefetch_stop(pdo_mimer_prefetch *prefetch);
+
+/* pauses the prefetch thread of a connection's statement, if any, before the PHP thread uses the connection's sessions */
+#define pdo_mimer_claim_sessions(mimer_dbh) do { \
+	if ((mimer_dbh)->prefetching != NULL) { \
+		pdo_mimer_prefetch_pause((mimer_dbh)->prefetching); \
+		(mimer_dbh)->prefetching = NULL; \
+	} \
+} while (0)
+
+/* like pdo_mimer_claim_sessions(), but leaves the statement's own prefetch thread running */
+#define pdo_mimer_claim_sessions_for(mimer_stmt) do { \
+	if ((mimer_stmt)->dbh->prefetching != (mimer_stmt)->prefetch.state) \
+		pdo_mimer_claim_sessions((mimer_stmt)->dbh); \
+} while (0)
+
 /**
  * @brief Checks if the statement will yield a result-set
  * @param mimer_stmt [in] A <code>MimerStatement</code>
@@ -84,12 +378,70 @@ typedef struct pdo_mimer_stmt_t {
 #define MimerStatementHasResultSet(mimer_stmt) ((mimer_stmt) != NULL && MimerColumnCount((mimer_stmt)) > 0)
 
 
+/* parameter type binding a PHP array to a single placeholder, which is expanded to one placeholder per element */
+#define MIMER_PARAM_ARRAY 0x100
+
 /* PDOMimer-specific attributes here */
 typedef enum pdo_mimer_attr {
     MIMER_ATTR_TRANS_OPTION = PDO_ATTR_DRIVER_SPECIFIC,
+    MIMER_ATTR_WARMUP_STATS,
+    MIMER_ATTR_RETRY_STATS,
+    MIMER_ATTR_DEFERRED_BEGIN,
+
+    /* statement attributes, also accepted as driver options of PDO::prepare() */
+    MIMER_ATTR_FETCH_SIZE,
+    MIMER_ATTR_MAX_ROWS,
+    MIMER_ATTR_QUERY_TIMEOUT,
+    MIMER_ATTR_DEDUP_STRINGS,
+    MIMER_ATTR_TRIM_CHAR,
+    MIMER_ATTR_PREFETCH_ROWS,
 } pdo_mimer_attr;
 
 
+/**
+ * @brief Reads a monotonic clock, used for the timing figures the driver reports.
+ * @return The current time in nanoseconds from an arbitrary starting point.
+ */
+static inline uint64_t pdo_mimer_hrtime(void) {
+#ifdef PHP_WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000
+		+ (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+
+/* counting costs a single test of the INI flag while disabled; the counters are module globals, so worker threads
+ * never count themselves */
+#define PDO_MIMER_STATS_ENABLED() UNEXPECTED(PDO_MIMER_G(stats_enabled))
+#define PDO_MIMER_STATS_ADD(counter, n) do { \
+	if (PDO_MIMER_STATS_ENABLED()) \
+		PDO_MIMER_G(stats).counter += (n); \
+} while (0)
+#define PDO_MIMER_STATS_INC(counter) PDO_MIMER_STATS_ADD(counter, 1)
+
+/**
+ * @brief Reads the clock for a timing counter.
+ * @return The time to pass to <code>PDO_MIMER_STATS_TIME()</code>, 0 when the counters are disabled.
+ */
+static inline uint64_t pdo_mimer_stats_start(void) {
+	return PDO_MIMER_STATS_ENABLED() ? pdo_mimer_hrtime() : 0;
+}
+
+#define PDO_MIMER_STATS_TIME(counter, started) do { \
+	if ((started) != 0) \
+		PDO_MIMER_G(stats).counter += pdo_mimer_hrtime() - (started); \
+} while (0)
+
 /********************************************
  *              LOB-specifics               *
  ********************************************/
@@ -103,6 +455,7 @@ typedef enum pdo_mimer_attr {
 typedef struct pdo_mimer_lob_stream_data_t {
 	MimerLob lob_handle;
     int32_t lob_type;
+	zval dbh_zv;  /* the PDO object, kept alive for its sessions to be claimed while reading */
 } pdo_mimer_lob_stream_data;
 
 extern php_stream *pdo_mimer_create_lob_stream(pdo_stmt_t *stmt, int colno, int32_t lob_type);
@@ -115,6 +468,7 @@ extern const php_stream_ops pdo_mimer_lob_stream_ops;
 /* Utilities that at some point could/should be provided by API instead */
 #define MimerIsDatetime(n) (abs(n)==MIMER_DATE||abs(n)==MIMER_TIME||abs(n)==MIMER_TIMESTAMP)
 #define MimerIsInterval(n) (abs(n)>=MIMER_INTERVAL_YEAR && abs(n) <= MIMER_INTERVAL_MINUTE_TO_SECOND)
+#define MimerIsPadded(n) (abs(n)==MIMER_CHARACTER||abs(n)==MIMER_NCHAR)
 #define MimerIsUnsigned(n) ((abs(n)<=MIMER_UNSIGNED_INTEGER && abs(n)>=MIMER_T_UNSIGNED_SMALLINT)||abs(n)==MIMER_T_UNSIGNED_BIGINT)
 
 typedef enum MimerParamMode {
@@ -125,4 +479,8 @@ typedef enum MimerParamMode {
 
 #define MimerParamIsOutput(n) (n==MIMER_PARAM_OUTPUT||n==MIMER_PARAM_INPUT_OUTPUT)
 
+/* sets a null-terminated string of the given length, refusing one with a NUL inside since the API would cut it short */
+#define pdo_mimer_set_string8(stmt, paramno, str, len) (memchr((str), '\0', (len)) != NULL ? \
+	PDO_MIMER_EMBEDDED_NUL : MimerSetString8((stmt), (paramno), (str)))
+
 #endif /* PHP_PDO_MIMER_INT_H */
\ No newline at end of file
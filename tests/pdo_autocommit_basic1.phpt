@@ -0,0 +1,64 @@
+--TEST--
+PDO Mimer(autocommit): group statements into an implicit transaction
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. autocommit is on by default
+2. with autocommit off, the first statement starts a transaction which lasts until commit or rollback
+3. turning autocommit on again commits the open transaction
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+function countRows(PDO $db) {
+    return (int)$db->query("SELECT COUNT(*) FROM basic")->fetchColumn();
+}
+
+try {
+    $db = new PDO($dsn);
+    var_dump($db->getAttribute(PDO::ATTR_AUTOCOMMIT));
+
+    $db->setAttribute(PDO::ATTR_AUTOCOMMIT, false);
+    var_dump($db->inTransaction());
+
+    $stmt = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    $stmt->execute([3, 'dolor']);
+    $db->exec("INSERT INTO basic VALUES (4, 'sit')");
+    var_dump($db->inTransaction());
+    $db->rollBack();
+    var_dump(countRows($db));
+
+    $stmt->execute([5, 'amet']);
+    $db->commit();
+    var_dump(countRows($db));
+
+    $db->exec("INSERT INTO basic VALUES (6, 'consectetur')");
+    $db->setAttribute(PDO::ATTR_AUTOCOMMIT, true);
+    var_dump($db->inTransaction());
+    var_dump(countRows($db));
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(false)
+bool(true)
+int(2)
+int(3)
+bool(false)
+int(4)
@@ -0,0 +1,66 @@
+--TEST--
+PDO Mimer(beginTransaction): deferred transaction start
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that with PDO::MIMER_ATTR_DEFERRED_BEGIN:
+1. an empty transaction can be committed and rolled back
+2. the transaction is started by the first statement and isolates its changes until commit
+3. the read-only option recorded at beginTransaction() is honoured
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db_1 = new PDO($dsn, null, null, [PDO::MIMER_ATTR_DEFERRED_BEGIN => true]);
+    $db_2 = new PDO($dsn);
+    var_dump($db_1->getAttribute(PDO::MIMER_ATTR_DEFERRED_BEGIN));
+
+    $db_1->beginTransaction();
+    var_dump($db_1->inTransaction());
+    $db_1->commit();
+    $db_1->beginTransaction();
+    $db_1->rollBack();
+    var_dump($db_1->inTransaction());
+
+    $db_1->beginTransaction();
+    $db_1->exec("INSERT INTO basic VALUES (3, 'dolor')");
+    var_dump((int)$db_2->query("SELECT COUNT(*) FROM basic")->fetchColumn());
+    $db_1->commit();
+    var_dump((int)$db_2->query("SELECT COUNT(*) FROM basic")->fetchColumn());
+
+    $db_1->setAttribute(PDO::MIMER_ATTR_TRANS_OPTION, PDO::MIMER_TRANS_READONLY);
+    $db_1->beginTransaction();
+    $db_1->setAttribute(PDO::MIMER_ATTR_TRANS_OPTION, PDO::MIMER_TRANS_READWRITE);
+    try {
+        $db_1->exec("INSERT INTO basic VALUES (4, 'sit')");
+    } catch (PDOException $e) {
+        print "read-only" . PHP_EOL;
+    }
+    $db_1->rollBack();
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+$db_1 = null;
+$db_2 = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+bool(false)
+int(2)
+int(3)
+read-only
@@ -0,0 +1,63 @@
+--TEST--
+PDO Mimer(Constructor): route reads to a second session
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Uses the test databank as read databank too. Verifies that:
+1. queries outside a transaction see committed data through the read session
+2. queries inside a read-write transaction stay on the primary session and see its uncommitted changes
+3. the session is picked on each execute, so a query prepared outside the transaction also sees them
+4. a read databank that cannot be connected to makes the constructor fail
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+if (!str_ends_with($dsn, ";"))
+    $dsn .= ";";
+preg_match('/dbname=([^;]*)/', $dsn, $matches);
+
+try {
+    $db = new PDO($dsn . "read_dbname=$matches[1]");
+    $count = $db->prepare("SELECT COUNT(*) FROM basic");
+
+    $count->execute();
+    var_dump((int)$count->fetchColumn());
+
+    $db->beginTransaction();
+    $db->exec("INSERT INTO basic VALUES (3, 'dolor')");
+    var_dump((int)$db->query("SELECT COUNT(*) FROM basic")->fetchColumn());
+    $count->execute();
+    var_dump((int)$count->fetchColumn());
+    $db->commit();
+
+    $count->execute();
+    var_dump((int)$count->fetchColumn());
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+try {
+    $db = new PDO($dsn . "read_dbname=non_existent_databank");
+    print "connected" . PHP_EOL;
+} catch (PDOException $e) {
+    print "failed" . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(2)
+int(3)
+int(3)
+int(3)
+failed
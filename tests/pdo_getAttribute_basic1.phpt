@@ -43,4 +43,4 @@ PDOMimerTestSetup::tearDown();
 ?>
 
 --EXPECTREGEX--
-(SQLSTATE\[IM001\]: Driver does not support this function: driver does not support that attribute\n*){5}
\ No newline at end of file
+(SQLSTATE\[IM001\]: Driver does not support this function: driver does not support that attribute\n*){4}
\ No newline at end of file
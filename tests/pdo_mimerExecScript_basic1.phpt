@@ -0,0 +1,83 @@
+--TEST--
+PDO Mimer(mimerExecScript): execute a multi-statement script
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. the script is split on semicolons outside of literals, comments and compound statements
+2. execution stops at the first error unless continue_on_error is given
+3. with the transaction option a failing script leaves no changes behind
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+function ids(PDO $db) {
+    return implode(",", $db->query("SELECT id FROM basic ORDER BY id")->fetchAll(PDO::FETCH_COLUMN));
+}
+
+$script = <<<SQL
+-- fixtures
+INSERT INTO basic VALUES (3, 'semi;colon');
+/* a comment; with a semicolon */
+INSERT INTO basic VALUES (4, 'it''s');;
+CREATE PROCEDURE add_row(IN x INT) MODIFIES SQL DATA BEGIN
+    INSERT INTO basic VALUES (x, 'proc');
+END;
+CALL add_row(5)
+SQL;
+
+try {
+    $db = new PDO($dsn);
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+
+    $result = $db->mimerExecScript($script);
+    var_dump(count($result));
+    print $result[2]['sql'] . PHP_EOL;
+    var_dump(is_float($result[0]['time_ms']), $result[0]['error']);
+    print ids($db) . PHP_EOL;
+
+    try {
+        $db->mimerExecScript("INSERT INTO basic VALUES (6, 'a'); INSERT INTO nonexistent VALUES (1); INSERT INTO basic VALUES (7, 'b')",
+            ['transaction' => true]);
+    } catch (PDOException $e) {
+        print "failed" . PHP_EOL;
+    }
+    print ids($db) . PHP_EOL;
+    var_dump($db->inTransaction());
+
+    $result = $db->mimerExecScript("INSERT INTO nonexistent VALUES (1); INSERT INTO basic VALUES (8, 'c')",
+        ['continue_on_error' => true]);
+    var_dump(count($result), $result[0]['error'][0] !== '00000', $result[1]['error']);
+    print ids($db) . PHP_EOL;
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(4)
+CREATE PROCEDURE add_row(IN x INT) MODIFIES SQL DATA BEGIN
+    INSERT INTO basic VALUES (x, 'proc');
+END
+bool(true)
+NULL
+1,2,3,4,5
+failed
+1,2,3,4,5
+bool(false)
+int(2)
+bool(true)
+NULL
+1,2,3,4,5,8
@@ -0,0 +1,47 @@
+--TEST--
+PDO Mimer(mimerExecScript): load a generated fixture as one script
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Runs the DML statements generated for a preset through mimerExecScript() and verifies that:
+1. every statement is executed without an error
+2. the rows are the same as when the statements are executed one by one with exec()
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic", false);
+$dsn = $util->getFullDSN();
+$dml = PDOMimerTestSQLGenerator::getPresetDML(PDOMimerTestCatalog::getPreset("db_basic"));
+
+try {
+    $db = new PDO($dsn);
+    $result = $db->mimerExecScript(implode(";\n", $dml));
+    var_dump(count($result) === count($dml));
+    var_dump(array_filter(array_column($result, 'error')));
+    $scripted = $db->query("SELECT * FROM basic ORDER BY id")->fetchAll(PDO::FETCH_NUM);
+    $db = null;
+
+    $util = new PDOMimerTestUtil("db_basic");
+    $db = new PDO($dsn);
+    var_dump($scripted === $db->query("SELECT * FROM basic ORDER BY id")->fetchAll(PDO::FETCH_NUM));
+    $db = null;
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+array(0) {
+}
+bool(true)
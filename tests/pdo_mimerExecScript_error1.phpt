@@ -0,0 +1,52 @@
+--TEST--
+PDO Mimer(mimerExecScript): error message survives the rollback of a failed script
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+The message of an error is fetched before the script's transaction is
+rolled back, so the rollback does not replace it before it is reported.
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$script = "DELETE FROM basic WHERE id = 6; INSERT INTO nonexistent VALUES (1)";
+
+try {
+    $db = new PDO($dsn);
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+
+    $result = $db->mimerExecScript($script, ['continue_on_error' => true]);
+    $expected = $result[1]['error'];
+    var_dump($expected[2] !== '');
+
+    try {
+        $db->mimerExecScript($script, ['transaction' => true]);
+    } catch (PDOException $e) {
+        var_dump($e->errorInfo[1] === $expected[1], str_ends_with($e->getMessage(), $expected[2]));
+    }
+
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_SILENT);
+    var_dump($db->mimerExecScript($script, ['transaction' => true]));
+    var_dump($db->errorInfo() === $expected);
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+bool(false)
+bool(true)
@@ -0,0 +1,91 @@
+--TEST--
+PDO Mimer(mimerGetStats): read the driver's performance counters
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--INI--
+pdo_mimer.stats=1
+
+--DESCRIPTION--
+Verifies that:
+1. prepares, executes, rows, cells by SQL type and bytes fetched are counted
+2. errors are counted by SQLSTATE class, keyed by the class as a string
+3. the counters are reset on request, and exported in the Prometheus text format
+4. nothing is counted while pdo_mimer.stats is off
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    $stats = $db->mimerGetStats(true);
+    var_dump($stats['enabled'], $stats['sessions_opened'] >= 1);
+
+    $stmt = $db->prepare("SELECT id, text FROM basic ORDER BY id");
+    $stmt->execute();
+    $stmt->fetchAll();
+
+    $stats = $db->mimerGetStats();
+    var_dump($stats['sessions_opened'], $stats['prepares'], $stats['executes'], $stats['rows_fetched']);
+    var_dump($stats['cells']['integer'], $stats['cells']['character'], $stats['bytes_in']);
+    var_dump(is_float($stats['execute_ms']), $stats['fetch_ms'] >= 0);
+
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_SILENT);
+    $db->query("SELECT * FROM no_such_table");
+    $stats = $db->mimerGetStats(true);
+    var_dump($stats['errors'], $stats['errors_by_class'], $stats['errors_by_class']['42']);
+
+    $stats = $db->mimerGetStats();
+    var_dump($stats['prepares'], $stats['rows_fetched'], $stats['errors_by_class']);
+
+    $db->query("SELECT id FROM basic")->fetchAll();
+    $text = $db->mimerExportStats();
+    var_dump(str_contains($text, "# TYPE pdo_mimer_rows_fetched_total counter\npdo_mimer_rows_fetched_total 2\n"));
+    var_dump(str_contains($text, "pdo_mimer_cells_total{type=\"integer\"} 2\n"));
+
+    ini_set('pdo_mimer.stats', '0');
+    $db->query("SELECT id FROM basic")->fetchAll();
+    $stats = $db->mimerGetStats();
+    var_dump($stats['enabled'], $stats['rows_fetched']);
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+int(0)
+int(1)
+int(1)
+int(2)
+int(2)
+int(2)
+int(10)
+bool(true)
+bool(true)
+int(1)
+array(1) {
+  [42]=>
+  int(1)
+}
+int(1)
+int(0)
+int(0)
+array(0) {
+}
+bool(true)
+bool(true)
+bool(false)
+int(2)
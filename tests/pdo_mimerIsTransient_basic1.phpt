@@ -0,0 +1,75 @@
+--TEST--
+PDO Mimer(mimerIsTransient): classify exceptions by SQLSTATE
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. native errors are mapped to a SQLSTATE class instead of the general error
+2. syntax errors are not transient
+3. transaction rollbacks and connection exceptions are transient
+4. a failed login is an authorization error and not transient, nor is a connection the server rejected
+5. a duplicate key is an integrity constraint violation and not transient, nor is a query timeout
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    try {
+        $db->prepare("Invalid SQL");
+    } catch (PDOException $e) {
+        var_dump($e->errorInfo[0]);
+        var_dump($db->mimerIsTransient($e));
+    }
+
+    try {
+        $db->exec("INSERT INTO basic VALUES (1, 'duplicate')");
+    } catch (PDOException $e) {
+        var_dump($e->errorInfo[0]);
+        var_dump($db->mimerIsTransient($e));
+    }
+
+    foreach (["40001", "08006", "23000", "08004", "28000", "HYT00", "HYT01"] as $sqlstate) {
+        $e = new PDOException("SQLSTATE[$sqlstate]");
+        $e->errorInfo = [$sqlstate, 0, ""];
+        var_dump($db->mimerIsTransient($e));
+    }
+
+    try {
+        new PDO("mimer:dbname=" . PDOMimerTestConfig::getDBName(), PDOMimerTestConfig::getUser(),
+            PDOMimerTestConfig::getPassword() . "wrong");
+    } catch (PDOException $e) {
+        var_dump($e->errorInfo[0]);
+        var_dump($db->mimerIsTransient($e));
+    }
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+string(5) "42000"
+bool(false)
+string(5) "23000"
+bool(false)
+bool(true)
+bool(true)
+bool(false)
+bool(false)
+bool(false)
+bool(false)
+bool(true)
+string(5) "28000"
+bool(false)
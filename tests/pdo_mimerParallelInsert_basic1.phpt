@@ -0,0 +1,106 @@
+--TEST--
+PDO Mimer(mimerParallelInsert): insert rows through several sessions
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. rows given as an array or a generator are all inserted, across the partitions
+2. partitioning by a key sends rows with the same key to the same partition
+3. with the commit policy "all" a failing partition rolls back every partition
+4. with the commit policy "partition" the other partitions are committed and the failure is reported in the result
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+function count_rows(PDO $db) {
+    return $db->query("SELECT COUNT(*) FROM basic")->fetchColumn();
+}
+
+function rows(int $from, int $to) {
+    for ($id = $from; $id <= $to; $id++)
+        yield [$id, "row $id"];
+}
+
+try {
+    $db = new PDO($dsn);
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+    $sql = "INSERT INTO basic VALUES (?, ?)";
+
+    $result = $db->mimerParallelInsert($sql, iterator_to_array(rows(3, 102)), 4, ['batch_size' => 7]);
+    var_dump($result['rows'], $result['committed'], count($result['partitions']));
+    var_dump(array_sum(array_column($result['partitions'], 'rows')), is_float($result['rows_per_sec']));
+    var_dump(count_rows($db));
+
+    $rows = [];
+    foreach (rows(103, 202) as $row)
+        $rows[] = ['id' => $row[0], 'text' => $row[0] % 2 ? 'odd' : 'even'];
+    $result = $db->mimerParallelInsert($sql, $rows, 3, ['key' => 'text']);
+    var_dump($result['rows'], count(array_filter(array_column($result['partitions'], 'rows'))) <= 2);
+
+    $result = $db->mimerParallelInsert($sql, rows(203, 210), 2);
+    var_dump($result['rows'], count_rows($db));
+
+    /* id 1 already exists, so the partition it lands in fails */
+    try {
+        $db->mimerParallelInsert($sql, [[1, 'dup'], [211, 'a'], [212, 'b'], [213, 'c']], 2);
+    } catch (PDOException $e) {
+        print "failed" . PHP_EOL;
+    }
+    var_dump(count_rows($db));
+
+    $result = $db->mimerParallelInsert($sql, [[1, 'dup'], [211, 'a'], [212, 'b'], [213, 'c']], 2,
+        ['commit' => 'partition']);
+    var_dump($result['rows'], $result['committed']);
+    var_dump($result['partitions'][0]['committed'], $result['partitions'][0]['error'] !== null);
+    var_dump($result['partitions'][1]['committed'], $result['partitions'][1]['error']);
+    var_dump(count_rows($db));
+
+    try {
+        $db->mimerParallelInsert($sql, [[1, 'a'], [2]], 2);
+    } catch (ValueError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+    try {
+        $db->mimerParallelInsert($sql, [], 0);
+    } catch (ValueError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(100)
+bool(true)
+int(4)
+int(100)
+bool(true)
+int(102)
+int(100)
+bool(true)
+int(8)
+int(210)
+failed
+int(210)
+int(2)
+bool(false)
+bool(false)
+bool(true)
+bool(true)
+NULL
+int(212)
+PDO::mimerParallelInsert(): Argument #2 ($rows) must contain non-empty arrays of the same number of values
+PDO::mimerParallelInsert(): Argument #3 ($sessions) must be between 1 and 64
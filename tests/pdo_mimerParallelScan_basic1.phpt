@@ -0,0 +1,115 @@
+--TEST--
+PDO Mimer(mimerParallelScan): fetch ranges through several sessions
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. the rows of every range are returned, in the order of the ranges by default
+2. with ordered disabled all rows are still returned
+3. fetch() and fetchAll() can be mixed, and support PDO::FETCH_ASSOC and PDO::FETCH_NUM
+4. a failing range is reported according to the error mode
+5. invalid arguments are rejected
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+    $stmt = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    for ($id = 3; $id <= 100; $id++)
+        $stmt->execute([$id, "row $id"]);
+
+    $sql = "SELECT id, text FROM basic WHERE id BETWEEN ? AND ? ORDER BY id";
+    $ranges = [];
+    for ($from = 1; $from <= 100; $from += 10)
+        $ranges[] = [$from, $from + 9];
+
+    $rows = $db->mimerParallelScan($sql, $ranges, 4)->fetchAll();
+    var_dump(count($rows), array_column($rows, 'id') === range(1, 100), $rows[1]);
+
+    $ids = array_column($db->mimerParallelScan($sql, $ranges, 3, ['ordered' => false])->fetchAll(), 'id');
+    sort($ids);
+    var_dump($ids === range(1, 100));
+
+    /* the workers wait for the reader after one range ahead */
+    $result = $db->mimerParallelScan($sql, $ranges, 4, ['max_pending' => 1]);
+    $ids = [];
+    while ($row = $result->fetch()) {
+        $ids[] = $row['id'];
+        usleep(100);
+    }
+    var_dump($ids === range(1, 100));
+
+    $result = $db->mimerParallelScan($sql, [[1, 1], [2, 2], [50, 49]], 2);
+    var_dump($result->fetch(PDO::FETCH_NUM), $result->fetchAll(), $result->fetch());
+
+    try {
+        $db->mimerParallelScan("SELECT id FROM basic WHERE id = ?", [[1], ['x']])->fetchAll();
+    } catch (PDOException $e) {
+        print "failed" . PHP_EOL;
+    }
+
+    try {
+        $db->mimerParallelScan($sql, [[1, 2], 3]);
+    } catch (TypeError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+    try {
+        $db->mimerParallelScan($sql, [], 65);
+    } catch (ValueError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+    try {
+        $db->mimerParallelScan($sql, [], 4, ['max_pending' => 0]);
+    } catch (ValueError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(100)
+bool(true)
+array(2) {
+  ["id"]=>
+  int(2)
+  ["text"]=>
+  string(5) "ipsum"
+}
+bool(true)
+bool(true)
+array(2) {
+  [0]=>
+  int(1)
+  [1]=>
+  string(5) "lorem"
+}
+array(1) {
+  [0]=>
+  array(2) {
+    ["id"]=>
+    int(2)
+    ["text"]=>
+    string(5) "ipsum"
+  }
+}
+bool(false)
+failed
+PDO::mimerParallelScan(): Argument #2 ($ranges) must contain only arrays of scalar or null values
+PDO::mimerParallelScan(): Argument #3 ($threads) must be between 1 and 64
+PDO::mimerParallelScan(): Argument #4 ($options) option "max_pending" must be greater than 0
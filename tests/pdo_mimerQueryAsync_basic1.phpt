@@ -0,0 +1,100 @@
+--TEST--
+PDO Mimer(mimerQueryAsync): run queries on worker threads
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. several queries run at the same time and each result returns its own rows
+2. await() and isReady() agree once the query has finished
+3. statements without a result set report the rows they affected
+4. a failing query reports its error through the error mode of the connection
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+
+    $first = $db->mimerQueryAsync("SELECT id, text FROM basic WHERE id = ?", [1]);
+    $all = $db->mimerQueryAsync("SELECT id, text FROM basic ORDER BY id");
+    $none = $db->mimerQueryAsync("SELECT id FROM basic WHERE id > ?", [100]);
+
+    var_dump($first->await(), $first->isReady());
+    var_dump($first->fetchAll());
+    var_dump($all->fetchAll(PDO::FETCH_NUM), $all->rowCount());
+    var_dump($none->fetchAll());
+
+    $insert = $db->mimerQueryAsync("INSERT INTO basic VALUES (?, ?)", [3, null]);
+    var_dump($insert->rowCount());
+    print implode(",", $db->query("SELECT id FROM basic ORDER BY id")->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+    $failing = $db->mimerQueryAsync("SELECT * FROM nonexistent");
+    try {
+        $failing->await();
+    } catch (PDOException $e) {
+        print "failed" . PHP_EOL;
+    }
+
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_SILENT);
+    var_dump($failing->fetchAll(), $db->errorInfo()[0] !== '00000');
+
+    try {
+        $db->mimerQueryAsync("SELECT id FROM basic WHERE id = ?", [[1]]);
+    } catch (TypeError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+array(1) {
+  [0]=>
+  array(2) {
+    ["id"]=>
+    int(1)
+    ["text"]=>
+    string(5) "lorem"
+  }
+}
+array(2) {
+  [0]=>
+  array(2) {
+    [0]=>
+    int(1)
+    [1]=>
+    string(5) "lorem"
+  }
+  [1]=>
+  array(2) {
+    [0]=>
+    int(2)
+    [1]=>
+    string(5) "ipsum"
+  }
+}
+int(2)
+array(0) {
+}
+int(1)
+1,2,3
+failed
+bool(false)
+bool(true)
+PDO::mimerQueryAsync(): Argument #2 ($params) must contain only scalar or null values
@@ -0,0 +1,76 @@
+--TEST--
+PDO Mimer(mimerSavepoint): partial rollback inside a transaction
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. rolling back to a savepoint undoes only the work done after it and keeps the transaction
+2. a savepoint survives a rollback to it, while later savepoints are discarded
+3. released savepoints and savepoints of ended transactions no longer exist
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+function ids(PDO $db) {
+    return implode(",", $db->query("SELECT id FROM basic ORDER BY id")->fetchAll(PDO::FETCH_COLUMN));
+}
+
+try {
+    $db = new PDO($dsn);
+    $db->beginTransaction();
+
+    $db->exec("INSERT INTO basic VALUES (3, 'dolor')");
+    var_dump($db->mimerSavepoint('first'));
+    $db->exec("INSERT INTO basic VALUES (4, 'sit')");
+    var_dump($db->mimerSavepoint('second'));
+    $db->exec("INSERT INTO basic VALUES (5, 'amet')");
+
+    var_dump($db->mimerRollbackTo('first'));
+    print ids($db) . PHP_EOL;
+    var_dump($db->inTransaction());
+
+    try {
+        $db->mimerRollbackTo('second');
+    } catch (PDOException $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+
+    $db->exec("INSERT INTO basic VALUES (6, 'consectetur')");
+    var_dump($db->mimerRollbackTo('first'));
+    var_dump($db->mimerRelease('first'));
+    $db->commit();
+    print ids($db) . PHP_EOL;
+
+    try {
+        $db->mimerSavepoint('outside');
+    } catch (PDOException $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+1,2,3
+bool(true)
+SQLSTATE[3B001]: Invalid savepoint specification: savepoint does not exist
+bool(true)
+bool(true)
+1,2,3
+There is no active transaction
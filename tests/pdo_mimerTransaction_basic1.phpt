@@ -0,0 +1,76 @@
+--TEST--
+PDO Mimer(mimerTransaction): run work in a transaction and retry on conflicts
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. the work is committed and its return value is returned
+2. work failing with a transaction rollback is retried with a fresh transaction
+3. other errors roll back and are rethrown without retrying
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    $options = ['attempts' => 3, 'backoff_ms' => 1];
+
+    var_dump($db->mimerTransaction(function (PDO $db) {
+        $db->exec("INSERT INTO basic VALUES (3, 'dolor')");
+        return $db->inTransaction();
+    }, $options));
+    var_dump($db->inTransaction());
+
+    $runs = 0;
+    var_dump($db->mimerTransaction(function (PDO $db) use (&$runs) {
+        $db->exec("INSERT INTO basic VALUES (" . (4 + $runs) . ", 'sit')");
+        if (++$runs < 3) {
+            $e = new PDOException("SQLSTATE[40001]: Serialization failure");
+            $e->errorInfo = ["40001", -10001, "Transaction aborted due to conflict"];
+            throw $e;
+        }
+        return $runs;
+    }, $options));
+
+    try {
+        $db->mimerTransaction(function (PDO $db) {
+            $db->exec("INSERT INTO basic VALUES (10, 'amet')");
+            throw new RuntimeException("not retried");
+        }, $options);
+    } catch (RuntimeException $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+
+    print implode(",", $db->query("SELECT id FROM basic ORDER BY id")->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+    var_dump($db->getAttribute(PDO::MIMER_ATTR_RETRY_STATS));
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(false)
+int(3)
+not retried
+1,2,3,6
+array(3) {
+  ["transactions"]=>
+  int(3)
+  ["retries"]=>
+  int(2)
+  ["conflicts"]=>
+  int(2)
+}
@@ -0,0 +1,48 @@
+--TEST--
+PDO Mimer(prepare): Repeated prepares of the same SQL with named placeholders
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+The second prepare of the same SQL reuses the cached rewrite, this verifies
+that the named placeholders still map to the right positions.
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$tblName = "basic";
+
+try {
+    $db = new PDO($dsn);
+    foreach ([1, 2, 1] as $id) {
+        $stmt = $db->prepare("SELECT text FROM $tblName WHERE id = :id AND text <> :text");
+        $stmt->bindValue(":text", "dolor");
+        $stmt->bindValue(":id", $id);
+        $stmt->execute();
+        var_dump($stmt->fetchColumn());
+    }
+
+    $stmt = $db->prepare("SELECT COUNT(*) FROM $tblName");
+    $stmt->execute();
+    var_dump($stmt->fetchColumn());
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+$stmt = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+string(5) "lorem"
+string(5) "ipsum"
+string(5) "lorem"
+int(2)
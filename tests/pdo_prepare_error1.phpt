@@ -29,4 +29,4 @@ PDOMimerTestSetup::tearDown();
 ?>
 
 --EXPECT--
-SQLSTATE[HY000]: General error: -12103 Syntax error, IDENTIFIER 'SQL'  assumed to mean 'COMMIT'
\ No newline at end of file
+SQLSTATE[42000]: Syntax error or access violation: -12103 Syntax error, IDENTIFIER 'SQL'  assumed to mean 'COMMIT'
\ No newline at end of file
@@ -35,4 +35,4 @@ PDOMimerTestSetup::tearDown();
 ?>
 
 --EXPECT--
-SQLSTATE[HY000]: General error: -12262 The type of the parameter marker cannot be determined
\ No newline at end of file
+SQLSTATE[42000]: Syntax error or access violation: -12262 The type of the parameter marker cannot be determined
\ No newline at end of file
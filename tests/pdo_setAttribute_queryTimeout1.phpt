@@ -0,0 +1,72 @@
+--TEST--
+PDO Mimer(setAttribute): fail fetching from queries past their timeout
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. the connection's PDO::MIMER_ATTR_QUERY_TIMEOUT is the default of new statements
+2. a fetch made once the timeout has passed fails with SQLSTATE[HYT00], both with the connection's and the
+   statement's own timeout
+3. the statement and the connection stay usable after a query has timed out
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+/* the timeout is checked between the rows fetched, so a pause between two fetches lets it pass */
+function fetchTooSlowly(PDOStatement $stmt) {
+    try {
+        $stmt->execute();
+        var_dump($stmt->fetchColumn());
+        sleep(2);
+        var_dump($stmt->fetchColumn());
+    } catch (PDOException $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+}
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION, PDO::MIMER_ATTR_QUERY_TIMEOUT => 1]);
+    var_dump($db->getAttribute(PDO::MIMER_ATTR_QUERY_TIMEOUT));
+
+    $stmt = $db->prepare("SELECT id FROM basic ORDER BY id");
+    var_dump($stmt->getAttribute(PDO::MIMER_ATTR_QUERY_TIMEOUT));
+    fetchTooSlowly($stmt);
+
+    $stmt->execute();
+    var_dump($stmt->fetchAll(PDO::FETCH_COLUMN));
+
+    $db->setAttribute(PDO::MIMER_ATTR_QUERY_TIMEOUT, 0);
+    fetchTooSlowly($db->prepare("SELECT id FROM basic ORDER BY id", [PDO::MIMER_ATTR_QUERY_TIMEOUT => 1]));
+
+    var_dump((int)$db->query("SELECT COUNT(*) FROM basic")->fetchColumn());
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(1)
+int(1)
+int(1)
+SQLSTATE[HYT00]: Timeout expired: -100009 Query timeout expired
+array(2) {
+  [0]=>
+  int(1)
+  [1]=>
+  int(2)
+}
+int(1)
+SQLSTATE[HYT00]: Timeout expired: -100009 Query timeout expired
+int(2)
@@ -0,0 +1,63 @@
+--TEST--
+PDO Mimer(bindValue): bind arrays to a single placeholder
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that arrays bound with PDO::MIMER_PARAM_ARRAY:
+1. expand to an IN list of any length, including a single and no element
+2. can be mixed with scalar named and positional parameters, before and after them
+3. can be re-bound with a different length on the same statement
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    $db->exec("INSERT INTO basic VALUES (3, 'dolor')");
+    $db->exec("INSERT INTO basic VALUES (4, 'sit')");
+    $db->exec("INSERT INTO basic VALUES (5, 'amet')");
+
+    $stmt = $db->prepare("SELECT text FROM basic WHERE id IN (:ids) ORDER BY id");
+    foreach ([[2], [1, 3], [5, 1, 4], [1, 2, 3, 4, 5], [], [3]] as $ids) {
+        $stmt->bindValue(':ids', $ids, PDO::MIMER_PARAM_ARRAY);
+        $stmt->execute();
+        print implode(",", $stmt->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+    }
+
+    $stmt = $db->prepare("SELECT id FROM basic WHERE id > ? AND id IN (?) AND text <> ? ORDER BY id");
+    $stmt->bindValue(1, 1, PDO::PARAM_INT);
+    $stmt->bindValue(2, [1, 2, 3, 5], PDO::MIMER_PARAM_ARRAY);
+    $stmt->bindValue(3, 'amet');
+    $stmt->execute();
+    print implode(",", $stmt->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+
+    $ids = [4, 5];
+    $stmt->bindParam(2, $ids, PDO::MIMER_PARAM_ARRAY);
+    $stmt->execute();
+    print implode(",", $stmt->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+ipsum
+lorem,dolor
+lorem,sit,amet
+lorem,ipsum,dolor,sit,amet
+
+dolor
+2,3
+4
@@ -0,0 +1,63 @@
+--TEST--
+PDO Mimer(bindValue): string parameters bound without copying, other types converted
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. strings filling the whole column are bound as they are
+2. non-string values bound to a string column are converted
+3. strings bound to numeric columns are converted
+4. a string with a NUL character inside is refused rather than cut short
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    $stmt = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+
+    $wide = str_repeat("abcdefghij", 10);
+    $stmt->execute([3, $wide]);
+    $stmt->bindValue(1, "4");
+    $stmt->bindValue(2, 42, PDO::PARAM_INT);
+    $stmt->execute();
+    $stmt->bindValue(1, 5.0);
+    $stmt->bindValue(2, true, PDO::PARAM_BOOL);
+    $stmt->execute();
+
+    foreach ($db->query("SELECT id, text FROM basic WHERE id > 2 ORDER BY id") as $row)
+        var_dump($row['id'], $row['text'] === $wide ? "wide" : $row['text']);
+
+    $db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+    try {
+        $stmt->execute([6, "abc\0def"]);
+    } catch (PDOException $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+    var_dump((int)$db->query("SELECT COUNT(*) FROM basic WHERE id = 6")->fetchColumn());
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(3)
+string(4) "wide"
+int(4)
+string(2) "42"
+int(5)
+string(1) "1"
+SQLSTATE[22023]: Invalid parameter value: -100012 String parameter contains a NUL character
+int(0)
@@ -0,0 +1,62 @@
+--TEST--
+PDO Mimer(stmt-fetch): column names shared across a connection's statements
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Column names are interned per connection. Verifies that:
+1. statements with the same columns key their rows by the same names
+2. names too long to be interned are read in full
+3. names stay right for a statement that outlives the table being emptied when full
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn);
+    $first = $db->prepare("SELECT id, text FROM basic WHERE id = 1");
+    $first->execute();
+    $second = $db->query("SELECT id, text FROM basic WHERE id = 2");
+    var_dump(array_keys($first->fetch(PDO::FETCH_ASSOC)) === array_keys($second->fetch(PDO::FETCH_ASSOC)));
+
+    $long = str_repeat("\u{20AC}", 100);
+    $row = $db->query("SELECT id AS \"$long\" FROM basic WHERE id = 1")->fetch(PDO::FETCH_ASSOC);
+    var_dump(array_keys($row) === [$long]);
+
+    for ($i = 0; $i < 40; $i++) {
+        $aliases = [];
+        for ($j = 0; $j < 30; $j++)
+            $aliases[] = "id AS \"c_{$i}_{$j}\"";
+        $row = $db->query("SELECT " . implode(", ", $aliases) . " FROM basic WHERE id = 1")->fetch(PDO::FETCH_ASSOC);
+        if (array_keys($row)[29] !== "c_{$i}_29")
+            print "wrong name in query $i" . PHP_EOL;
+    }
+
+    $first->execute();
+    var_dump($first->fetch(PDO::FETCH_ASSOC));
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+$first = $second = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+array(2) {
+  ["id"]=>
+  int(1)
+  ["text"]=>
+  string(5) "lorem"
+}
@@ -0,0 +1,55 @@
+--TEST--
+PDO Mimer(stmt-getAttribute): getting statement attributes
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. the Mimer statement attributes can be given as options to prepare() and read back
+2. unset statement attributes read as 0
+3. the generic attribute constants defined by PDO and the connection attributes are not statement attributes
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$tblName = "basic";
+
+$max_pdo_attr_const_val = 21;
+
+$db = new PDO($dsn);
+$stmt = $db->prepare("SELECT * FROM $tblName", [PDO::MIMER_ATTR_FETCH_SIZE => 50, PDO::MIMER_ATTR_MAX_ROWS => 10]);
+var_dump($stmt->getAttribute(PDO::MIMER_ATTR_FETCH_SIZE));
+var_dump($stmt->getAttribute(PDO::MIMER_ATTR_MAX_ROWS));
+var_dump($stmt->getAttribute(PDO::MIMER_ATTR_QUERY_TIMEOUT));
+
+// Test getting all generic attribute constants, and a connection attribute
+$errors = [];
+foreach (array_merge(range(0, $max_pdo_attr_const_val), [PDO::MIMER_ATTR_TRANS_OPTION]) as $attr) {
+    try {
+        $stmt->getAttribute($attr);
+    } catch (PDOException $e) {
+        $errors[] = $e->getMessage();
+    }
+}
+print_r(array_count_values($errors));
+
+$stmt = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(50)
+int(10)
+int(0)
+Array
+(
+    [SQLSTATE[IM001]: Driver does not support this function: driver doesn't support getting that attribute] => 22
+)
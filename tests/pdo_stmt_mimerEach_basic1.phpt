@@ -0,0 +1,81 @@
+--TEST--
+PDO Mimer(stmt-mimerEach): pass each row of a result set to a callback
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. mimerEach() passes every row, as an associative or numeric array, and returns the number of rows
+2. with a batch size, rows are passed in arrays of at most that many rows
+3. returning false from the callback stops the iteration
+4. rows kept by the callback are not changed by later rows
+5. a statement that was not executed is reported
+6. a numeric column name gives the same key as with fetch()
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION, PDO::ATTR_CASE => PDO::CASE_LOWER]);
+    $db->exec("INSERT INTO basic VALUES (3, 'dolor')");
+    $stmt = $db->prepare("SELECT id, text FROM basic ORDER BY id");
+
+    try {
+        $stmt->mimerEach(function ($row) {});
+    } catch (PDOException $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+
+    $stmt->execute();
+    $kept = [];
+    var_dump($stmt->mimerEach(function (array $row) use (&$kept) { $kept[] = $row; }));
+    var_dump($kept === [['id' => 1, 'text' => 'lorem'], ['id' => 2, 'text' => 'ipsum'], ['id' => 3, 'text' => 'dolor']]);
+
+    $stmt->execute();
+    var_dump($stmt->mimerEach(function (array $rows) { print json_encode($rows) . PHP_EOL; }, PDO::FETCH_NUM, 2));
+
+    $stmt->execute();
+    var_dump($stmt->mimerEach(function (array $row) { print $row['text'] . PHP_EOL; return $row['id'] < 2; }));
+
+    /* a numeric column name is keyed as fetch() keys it */
+    $aliased = $db->prepare("SELECT id AS \"1\" FROM basic WHERE id = 1");
+    $aliased->execute();
+    $fetched = $aliased->fetch(PDO::FETCH_ASSOC);
+    $aliased->execute();
+    $aliased->mimerEach(function (array $row) use ($fetched) { var_dump($row === $fetched, $row[1]); });
+
+    try {
+        $stmt->execute();
+        $stmt->mimerEach(function ($row) {}, PDO::FETCH_OBJ);
+    } catch (ValueError $e) {
+        print $e->getMessage() . PHP_EOL;
+    }
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+SQLSTATE[HY010]: Function sequence error: the statement has no result set to iterate
+int(3)
+bool(true)
+[[1,"lorem"],[2,"ipsum"]]
+[[3,"dolor"]]
+int(3)
+lorem
+ipsum
+int(2)
+bool(true)
+int(1)
+PDOStatement::mimerEach(): Argument #2 ($mode) must be either PDO::FETCH_ASSOC or PDO::FETCH_NUM
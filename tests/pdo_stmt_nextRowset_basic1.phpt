@@ -0,0 +1,58 @@
+--TEST--
+PDO Mimer(stmt-nextRowset): end the result set of a statement
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. nextRowset() reports that there is no further result set without raising an error
+2. the statement has no columns afterwards
+3. the statement can be executed again
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+    $stmt = $db->prepare("SELECT id, text FROM basic ORDER BY id");
+    $stmt->execute();
+    var_dump($stmt->columnCount());
+    var_dump($stmt->fetchColumn());
+
+    var_dump($stmt->nextRowset());
+    var_dump($stmt->columnCount());
+    var_dump($stmt->errorCode());
+
+    $stmt->execute();
+    var_dump($stmt->columnCount());
+    var_dump($stmt->fetchAll(PDO::FETCH_COLUMN));
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+$stmt = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(2)
+int(1)
+bool(false)
+int(0)
+string(5) "00000"
+int(2)
+array(2) {
+  [0]=>
+  int(1)
+  [1]=>
+  int(2)
+}
@@ -0,0 +1,72 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): setting statement attributes
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. PDO::MIMER_ATTR_MAX_ROWS stops the result set early
+2. PDO::MIMER_ATTR_FETCH_SIZE does not change the rows fetched
+3. negative values are rejected
+4. the generic attribute constants defined by PDO and the connection attributes cannot be set on a statement
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$tblName = "basic";
+
+$max_pdo_attr_const_val = 21;
+
+$db = new PDO($dsn);
+$db->exec("INSERT INTO $tblName VALUES (3, 'dolor')");
+$stmt = $db->prepare("SELECT id FROM $tblName ORDER BY id");
+
+var_dump($stmt->setAttribute(PDO::MIMER_ATTR_MAX_ROWS, 2));
+$stmt->execute();
+print implode(",", $stmt->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+
+var_dump($stmt->setAttribute(PDO::MIMER_ATTR_MAX_ROWS, 0));
+var_dump($stmt->setAttribute(PDO::MIMER_ATTR_FETCH_SIZE, 2));
+$stmt->execute();
+print implode(",", $stmt->fetchAll(PDO::FETCH_COLUMN)) . PHP_EOL;
+
+try {
+    $stmt->setAttribute(PDO::MIMER_ATTR_QUERY_TIMEOUT, -1);
+} catch (ValueError $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+// Test setting all generic attribute constants, and a connection attribute
+$errors = [];
+foreach (array_merge(range(0, $max_pdo_attr_const_val), [PDO::MIMER_ATTR_TRANS_OPTION]) as $attr) {
+    try {
+        $stmt->setAttribute($attr, 0);
+    } catch (PDOException $e) {
+        $errors[] = $e->getMessage();
+    }
+}
+print_r(array_count_values($errors));
+
+$stmt = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+1,2
+bool(true)
+bool(true)
+1,2,3
+Attribute value must be greater than or equal to 0
+Array
+(
+    [SQLSTATE[IM001]: Driver does not support this function: -100010 driver doesn't support setting that attribute] => 23
+)
@@ -0,0 +1,58 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): share repeated string values between fetched rows
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. PDO::MIMER_ATTR_DEDUP_STRINGS is off by default and can be given to prepare() or set on the statement
+2. rows fetched with deduplication hold the same values as without it
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$sql = "SELECT id, text FROM basic ORDER BY id";
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+    $insert = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    for ($id = 3; $id <= 40; $id++)
+        $insert->execute([$id, ['lorem', 'ipsum', '', str_repeat('x', 80)][$id % 4]]);
+
+    $plain = $db->prepare($sql);
+    var_dump($plain->getAttribute(PDO::MIMER_ATTR_DEDUP_STRINGS));
+    $plain->execute();
+    $expected = $plain->fetchAll(PDO::FETCH_ASSOC);
+
+    $dedup = $db->prepare($sql, [PDO::MIMER_ATTR_DEDUP_STRINGS => true]);
+    var_dump($dedup->getAttribute(PDO::MIMER_ATTR_DEDUP_STRINGS));
+    for ($i = 0; $i < 2; $i++) {
+        $dedup->execute();
+        var_dump($dedup->fetchAll(PDO::FETCH_ASSOC) === $expected);
+    }
+
+    var_dump($dedup->setAttribute(PDO::MIMER_ATTR_DEDUP_STRINGS, false));
+    $dedup->execute();
+    var_dump($dedup->fetchAll(PDO::FETCH_ASSOC) === $expected);
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(false)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
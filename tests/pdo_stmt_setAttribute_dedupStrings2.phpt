@@ -0,0 +1,70 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): deduplicated values are shared, and columns without repeats stop being deduplicated
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. rows fetched with PDO::MIMER_ATTR_DEDUP_STRINGS share one string per repeated value, so they take far less memory
+2. padded CHAR values longer than 64 bytes are shared when their trimmed value is not
+3. a column whose values are not repeated keeps returning the right values once it is no longer deduplicated, after
+   1024 lookups
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+
+function fetch_column(PDO $db, string $sql, bool $dedup, bool $trim = false): array {
+    $stmt = $db->prepare($sql, [PDO::MIMER_ATTR_DEDUP_STRINGS => $dedup, PDO::MIMER_ATTR_TRIM_CHAR => $trim]);
+    $before = memory_get_usage();
+    $stmt->execute();
+    $values = $stmt->fetchAll(PDO::FETCH_COLUMN);
+    return [memory_get_usage() - $before, $values];
+}
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+    $insert = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    $db->beginTransaction();
+    for ($id = 3; $id <= 2600; $id++)
+        $insert->execute([$id, $id <= 1100 ? str_repeat('s', 60) : "distinct $id"]);
+    $db->commit();
+
+    $repeated = "SELECT text FROM basic WHERE id BETWEEN 3 AND 1100 ORDER BY id";
+    [$plain_bytes, $expected] = fetch_column($db, $repeated, false);
+    [$dedup_bytes, $values] = fetch_column($db, $repeated, true);
+    var_dump(count($values), $values === $expected, $dedup_bytes < $plain_bytes / 2);
+
+    $padded = "SELECT CAST(text AS CHAR(100)) FROM basic WHERE id BETWEEN 3 AND 1100 ORDER BY id";
+    [$plain_bytes, $expected] = fetch_column($db, $padded, false, true);
+    [$dedup_bytes, $values] = fetch_column($db, $padded, true, true);
+    var_dump(strlen($values[0]), $values === $expected, $dedup_bytes < $plain_bytes / 2);
+
+    $distinct = "SELECT text FROM basic WHERE id > 1100 ORDER BY id";
+    [, $expected] = fetch_column($db, $distinct, false);
+    [, $values] = fetch_column($db, $distinct, true);
+    var_dump(count($values), $values === $expected);
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(1098)
+bool(true)
+bool(true)
+int(60)
+bool(true)
+bool(true)
+int(1500)
+bool(true)
@@ -0,0 +1,76 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): fetch rows ahead on a separate thread
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. rows fetched with PDO::MIMER_ATTR_PREFETCH_ROWS are the same as those fetched without it
+2. the connection can be used by other statements while the rows of a prefetching statement are being read
+3. a prefetching statement can be closed before its end and executed again
+4. the attribute can be given to prepare() or set on the statement
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$sql = "SELECT id, text, CAST(id AS DOUBLE PRECISION) AS d, CAST(id AS DECIMAL(10, 2)) AS n FROM basic ORDER BY id";
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+    $insert = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    for ($id = 3; $id <= 100; $id++)
+        $insert->execute([$id, $id % 3 ? str_repeat('x', $id) : null]);
+
+    $plain = $db->prepare($sql);
+    var_dump($plain->getAttribute(PDO::MIMER_ATTR_PREFETCH_ROWS));
+    $plain->execute();
+    $expected = $plain->fetchAll(PDO::FETCH_ASSOC);
+
+    $prefetch = $db->prepare($sql, [PDO::MIMER_ATTR_PREFETCH_ROWS => 16]);
+    var_dump($prefetch->getAttribute(PDO::MIMER_ATTR_PREFETCH_ROWS));
+    $prefetch->execute();
+    var_dump($prefetch->fetchAll(PDO::FETCH_ASSOC) === $expected);
+
+    $prefetch->execute();
+    $rows = [];
+    while ($row = $prefetch->fetch(PDO::FETCH_ASSOC)) {
+        $rows[] = $row;
+        if ($row['id'] % 10 == 0)
+            $db->query("SELECT COUNT(*) FROM basic")->fetchColumn();
+    }
+    var_dump($rows === $expected);
+
+    $prefetch->execute();
+    var_dump($prefetch->fetch(PDO::FETCH_ASSOC) === $expected[0]);
+    var_dump($prefetch->closeCursor());
+    $prefetch->execute();
+    var_dump($prefetch->fetchAll(PDO::FETCH_ASSOC) === $expected);
+
+    var_dump($plain->setAttribute(PDO::MIMER_ATTR_PREFETCH_ROWS, 1));
+    $plain->execute();
+    var_dump($plain->fetchAll(PDO::FETCH_ASSOC) === $expected);
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+int(0)
+int(16)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
@@ -0,0 +1,87 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): interleave a prefetching cursor with other cursors
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. rows can be fetched alternately from a prefetching cursor and a plain forward-only cursor
+2. the same holds with a scrollable cursor, and with a cursor opened while the prefetching one is half read
+3. two prefetching cursors can be read alternately
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$sql = "SELECT id, text FROM basic ORDER BY id";
+
+function interleave(PDOStatement $a, PDOStatement $b) {
+    $rows_a = $rows_b = [];
+    do {
+        $row_a = $a->fetch(PDO::FETCH_ASSOC);
+        $row_b = $b->fetch(PDO::FETCH_ASSOC);
+        if ($row_a)
+            $rows_a[] = $row_a;
+        if ($row_b)
+            $rows_b[] = $row_b;
+    } while ($row_a || $row_b);
+    return [$rows_a, $rows_b];
+}
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+    $insert = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    for ($id = 3; $id <= 200; $id++)
+        $insert->execute([$id, "row $id"]);
+
+    $expected = $db->query($sql)->fetchAll(PDO::FETCH_ASSOC);
+
+    $prefetch = $db->prepare($sql, [PDO::MIMER_ATTR_PREFETCH_ROWS => 8]);
+    $plain = $db->prepare($sql);
+    $prefetch->execute();
+    $plain->execute();
+    [$a, $b] = interleave($prefetch, $plain);
+    var_dump($a === $expected, $b === $expected);
+
+    $scroll = $db->prepare($sql, [PDO::ATTR_CURSOR => PDO::CURSOR_SCROLL]);
+    $prefetch->execute();
+    $scroll->execute();
+    [$a, $b] = interleave($scroll, $prefetch);
+    var_dump($a === $expected, $b === $expected);
+
+    $prefetch->execute();
+    $first = [];
+    for ($i = 0; $i < 50; $i++)
+        $first[] = $prefetch->fetch(PDO::FETCH_ASSOC);
+    $plain->execute();
+    [$a, $b] = interleave($prefetch, $plain);
+    var_dump(array_merge($first, $a) === $expected, $b === $expected);
+
+    $other = $db->prepare($sql, [PDO::MIMER_ATTR_PREFETCH_ROWS => 3]);
+    $prefetch->execute();
+    $other->execute();
+    [$a, $b] = interleave($prefetch, $other);
+    var_dump($a === $expected, $b === $expected);
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
+bool(true)
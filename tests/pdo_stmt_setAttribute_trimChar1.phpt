@@ -0,0 +1,67 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): trim the padding of CHAR values
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. CHAR values are returned padded by default
+2. with PDO::MIMER_ATTR_TRIM_CHAR, trailing spaces are removed from CHAR values but not from VARCHAR values
+3. the attribute can be given to prepare() or set on the statement
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$sql = "SELECT CAST(text AS CHAR(8)) AS c, CAST(text || '  ' AS VARCHAR(10)) AS v FROM basic WHERE id = 1";
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+
+    $stmt = $db->prepare($sql);
+    var_dump($stmt->getAttribute(PDO::MIMER_ATTR_TRIM_CHAR));
+    $stmt->execute();
+    var_dump($stmt->fetch(PDO::FETCH_NUM));
+
+    var_dump($stmt->setAttribute(PDO::MIMER_ATTR_TRIM_CHAR, true));
+    $stmt->execute();
+    var_dump($stmt->fetch(PDO::FETCH_NUM));
+
+    $stmt = $db->prepare($sql, [PDO::MIMER_ATTR_TRIM_CHAR => true, PDO::MIMER_ATTR_DEDUP_STRINGS => true]);
+    $stmt->execute();
+    var_dump($stmt->fetch(PDO::FETCH_NUM));
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+bool(false)
+array(2) {
+  [0]=>
+  string(8) "lorem   "
+  [1]=>
+  string(7) "lorem  "
+}
+bool(true)
+array(2) {
+  [0]=>
+  string(5) "lorem"
+  [1]=>
+  string(7) "lorem  "
+}
+array(2) {
+  [0]=>
+  string(5) "lorem"
+  [1]=>
+  string(7) "lorem  "
+}
@@ -0,0 +1,57 @@
+--TEST--
+PDO Mimer(stmt-setAttribute): trimming and deduplication apply to rows decoded by other threads
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that PDO::MIMER_ATTR_TRIM_CHAR and PDO::MIMER_ATTR_DEDUP_STRINGS give the same values for rows read
+directly, prefetched by PDO::MIMER_ATTR_PREFETCH_ROWS, returned by PDO::mimerQueryAsync() and by
+PDO::mimerParallelScan().
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = $util->getFullDSN();
+$sql = "SELECT id, CAST(text AS CHAR(8)) AS c FROM basic WHERE id BETWEEN ? AND ? ORDER BY id";
+$options = [PDO::MIMER_ATTR_TRIM_CHAR => true, PDO::MIMER_ATTR_DEDUP_STRINGS => true];
+
+try {
+    $db = new PDO($dsn, null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+    $insert = $db->prepare("INSERT INTO basic VALUES (?, ?)");
+    for ($id = 3; $id <= 40; $id++)
+        $insert->execute([$id, ['lorem', 'ipsum'][$id % 2]]);
+
+    $stmt = $db->prepare($sql, $options);
+    $stmt->execute([1, 40]);
+    $expected = $stmt->fetchAll(PDO::FETCH_ASSOC);
+    var_dump($expected[0]['c']);
+
+    $stmt = $db->prepare($sql, $options + [PDO::MIMER_ATTR_PREFETCH_ROWS => 8]);
+    $stmt->execute([1, 40]);
+    var_dump($stmt->fetchAll(PDO::FETCH_ASSOC) === $expected);
+
+    var_dump($db->mimerQueryAsync($sql, [1, 40], $options)->fetchAll() === $expected);
+    var_dump($db->mimerQueryAsync($sql, [1, 1])->fetchAll()[0]['c']);
+
+    $ranges = [[1, 10], [11, 20], [21, 30], [31, 40]];
+    var_dump($db->mimerParallelScan($sql, $ranges, 2, $options)->fetchAll() === $expected);
+} catch (PDOException $e) {
+    print $e->getMessage() . PHP_EOL;
+}
+
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+string(5) "lorem"
+bool(true)
+bool(true)
+string(8) "lorem   "
+bool(true)
@@ -0,0 +1,57 @@
+--TEST--
+PDO Mimer(warm-up): statements listed in a warm-up file are prepared at connect
+
+--EXTENSIONS--
+pdo
+pdo_mimer
+
+--DESCRIPTION--
+Verifies that:
+1. the statements in the file given by the DSN option warmup are prepared when connecting
+2. comments, blank lines and trailing semicolons are ignored and failing statements are counted
+3. a matching prepare() takes over the warmed statement
+
+--SKIPIF--
+<?php require_once 'pdo_tests_util.inc';
+PDOMimerTestUtil::commonSkipChecks();
+?>
+
+--FILE--
+<?php require_once 'pdo_tests_util.inc';
+$util = new PDOMimerTestUtil("db_basic");
+$dsn = rtrim($util->getFullDSN(), ';');
+$tblName = "basic";
+
+$file = tempnam(sys_get_temp_dir(), "pdo_mimer_warmup");
+file_put_contents($file, "-- hot queries\n" .
+    "SELECT * FROM $tblName WHERE id = ?\n\n" .
+    "SELECT text FROM $tblName;\n" .
+    "SELECT * FROM no_such_table\n");
+
+try {
+    $db = new PDO("$dsn;warmup=$file");
+    $stats = $db->getAttribute(PDO::MIMER_ATTR_WARMUP_STATS);
+    printf("prepared: %d, failed: %d, used: %d\n", $stats["prepared"], $stats["failed"], $stats["used"]);
+
+    $stmt = $db->prepare("SELECT * FROM $tblName WHERE id = ?");
+    $stmt->execute([2]);
+    var_dump($stmt->fetchColumn(1));
+
+    $stats = $db->getAttribute(PDO::MIMER_ATTR_WARMUP_STATS);
+    printf("used: %d\n", $stats["used"]);
+    var_dump($stats["time_ms"] > 0);
+} catch (PDOException $e) {
+    print $e->getMessage();
+}
+
+unlink($file);
+$stmt = null;
+$db = null;
+PDOMimerTestSetup::tearDown();
+?>
+
+--EXPECT--
+prepared: 2, failed: 1, used: 0
+string(5) "ipsum"
+used: 1
+bool(true)